@@ -260,6 +260,7 @@ AttributeRegistry::AttributeRegistry() {
 
 void AttributeRegistry::register_write_handler(const StringName& attribute_name, const AttributeHandlerFactory<WriteHandler>& factory, const int64_t priority) {
 	write_handler_factories.insert_or_assign(attribute_name, FactoryWithPriority<WriteHandler>{ factory, priority });
+	write_handlers_version.fetch_add(1, std::memory_order_release);
 }
 
 void AttributeRegistry::register_write_handler(const StringName& attribute_name, const Callable& factory_callable, const int64_t priority) {
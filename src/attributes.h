@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <optional>
 #include <unordered_map>
@@ -28,6 +29,7 @@ struct GodotAttributes {
     DECLARE_GODOT_ATTRIBUTE(color, Color)
     DECLARE_GODOT_ATTRIBUTE(default_black, DefaultBlack)
     DECLARE_GODOT_ATTRIBUTE(default_white, DefaultWhite)
+    DECLARE_GODOT_ATTRIBUTE(element_count, ElementCount)
     DECLARE_GODOT_ATTRIBUTE(export_param, ExportParam)
     DECLARE_GODOT_ATTRIBUTE(export_property, Export)
     DECLARE_GODOT_ATTRIBUTE(frame_id, FrameId)
@@ -76,6 +78,7 @@ public:
 private:
 	mutable UniqueRID<godot::RenderingServer> black_texture = UniqueRID(godot::RenderingServer::get_singleton());
     std::unordered_map<godot::StringName, FactoryWithPriority<WriteHandler>, gdslang::GodotHasher> write_handler_factories;
+    std::atomic<uint64_t> write_handlers_version{};
 
 public:
     AttributeRegistry();
@@ -87,6 +90,9 @@ public:
     void register_write_handler(const godot::StringName& attribute_name, const AttributeHandlerFactory<WriteHandler>& factory, int64_t priority = PRIORITY_DEFAULT);
     void register_write_handler(const godot::StringName& attribute_name, const godot::Callable& factory_callable, int64_t priority = PRIORITY_DEFAULT);
     std::optional<FactoryWithPriority<WriteHandler>> get_write_handler(const godot::StringName& attribute_name);
+    // bumped on every registration, so shapes can drop handlers they instantiated earlier
+    // (write plans already compiled by a task keep theirs until the task's shader changes)
+    [[nodiscard]] uint64_t get_write_handlers_version() const { return write_handlers_version.load(std::memory_order_acquire); }
 
     static AttributeRegistry* get_instance();
 
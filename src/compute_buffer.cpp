@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "godot_cpp/classes/engine.hpp"
 #include "godot_cpp/classes/rd_sampler_state.hpp"
 #include "godot_cpp/classes/rd_uniform.hpp"
@@ -10,17 +12,30 @@
 
 using namespace godot;
 
-ComputeBuffer::ComputeBuffer(RenderingDevice* p_rendering_device, const ComputeBufferType p_type) : rendering_device(p_rendering_device), rid(p_rendering_device), type(p_type) { }
+ComputeBuffer::ComputeBuffer(RenderingDevice* p_rendering_device, const ComputeBufferType p_type) : growth_factor(DEFAULT_GROWTH_FACTOR), dirty_merge_gap(DEFAULT_DIRTY_MERGE_GAP), data_format(RenderingDevice::DATA_FORMAT_R32G32B32A32_SFLOAT), rendering_device(p_rendering_device), rid(p_rendering_device), type(p_type) { }
+
+ComputeBuffer::~ComputeBuffer() {
+	for (const ConstantBufferPool::Allocation& allocation : ring) {
+		pool->release(allocation);
+	}
+}
 
 void ComputeBuffer::write(const int64_t offset, const std::span<const uint8_t> data) {
 	ERR_FAIL_COND_MSG(get_is_fixed_size() && buffer.size() == 0, "Attempt to write fixed-size buffer before initialize!");
 	ERR_FAIL_COND_MSG(offset + data.size() > buffer.size(), "Attempt to write past end of buffer!");
-	const int64_t size = Math::min<size_t>(data.size(), buffer.size() - offset);
-	if (memcmp(buffer.ptr(), data.data(), size)) {
-		memcpy(buffer.ptrw() + offset, data.data(), size);
-		dirty_start = Math::min(offset, dirty_start);
-		dirty_end = Math::max<int64_t>(offset + data.size(), dirty_end);
+	const int64_t copy_size = Math::min<size_t>(data.size(), buffer.size() - offset);
+	const uint8_t* current = buffer.ptr() + offset;
+	const uint8_t* source = data.data();
+	// only the bytes between the first and last difference have to be uploaded
+	const int64_t first = std::mismatch(current, current + copy_size, source).first - current;
+	if (first == copy_size)
+		return;
+	int64_t last = copy_size;
+	while (last > first && current[last - 1] == source[last - 1]) {
+		--last;
 	}
+	memcpy(buffer.ptrw() + offset + first, source + first, last - first);
+	_mark_dirty(offset + first, offset + last);
 }
 
 void ComputeBuffer::write(const int64_t offset, const int64_t size, const Variant& data, const ShaderTypeLayoutShape::MatrixLayout matrix_layout) {
@@ -33,73 +48,224 @@ void ComputeBuffer::write(const int64_t offset, const int64_t size, const Varian
 	}
 }
 
-void ComputeBuffer::set_size(const int64_t size) {
+void ComputeBuffer::set_size(const int64_t p_size) {
 	ERR_FAIL_COND_MSG(get_is_fixed_size(), "Attempted to change size of fixed size buffer!");
+	ERR_FAIL_COND(p_size < 0);
+	size = p_size;
 	const int64_t alignment = get_alignment();
-	if (alignment > 0) {
-		buffer.resize(aligned_size(size, alignment));
-	} else {
-		buffer.resize(size);
+	const int64_t required = alignment > 0 ? aligned_size(size, alignment) : size;
+	if (required > buffer.size()) {
+		if (buffer.is_empty()) {
+			buffer.resize(required);
+		} else {
+			// growing geometrically keeps the number of reallocations of a steadily growing buffer logarithmic
+			reserve(Math::max<int64_t>(required, buffer.size() * Math::max(get_growth_factor(), 1.0)));
+		}
+	}
+}
+
+void ComputeBuffer::reserve(const int64_t capacity) {
+	ERR_FAIL_COND_MSG(get_is_fixed_size(), "Attempted to change size of fixed size buffer!");
+	const int64_t alignment = get_alignment();
+	const int64_t aligned_capacity = alignment > 0 ? aligned_size(capacity, alignment) : capacity;
+	if (aligned_capacity > buffer.size()) {
+		buffer.resize(aligned_capacity);
 	}
 }
 
-void ComputeBuffer::flush() {
+void ComputeBuffer::flush(int64_t& r_upload_budget) {
 	ERR_FAIL_NULL(rendering_device);
 
 	if (!get_is_fixed_size()) {
-		if (remote_size < buffer.size() && rid.is_valid()) {
+		_shrink_to_fit();
+		if (remote_size != buffer.size() && rid.is_valid()) {
+			// the recreated buffer is initialized with the whole shadow copy
 			rid.reset();
-			dirty_start = 0;
-			dirty_end = buffer.size();
 		} else if (buffer.is_empty()) {
-			// the buffer cannot be 0 bytes
-			set_size(256);
-			dirty_start = 0;
-			dirty_end = buffer.size();
+			reserve(MIN_CAPACITY);
 		}
 	}
 
-	if (!rid.is_valid()) {
-		ERR_FAIL_COND(buffer.is_empty());
-		rid = _create_buffer();
-	} else if (dirty_start != dirty_end) {
-		_update_buffer();
+	if (type == ComputeBufferType::CONSTANT_BUFFER) {
+		_flush_ring();
+		dirty_ranges.clear();
+	} else {
+		if (!rid.is_valid()) {
+			ERR_FAIL_COND(buffer.is_empty());
+			// buffers past the remaining upload budget are created empty and streamed in over the following frames
+			const bool stream = buffer.size() > r_upload_budget;
+			rid = _create_buffer(!stream);
+			dirty_ranges.clear();
+			if (stream) {
+				dirty_ranges.emplace_back(0, buffer.size());
+			} else if (r_upload_budget != UNLIMITED_UPLOAD_BUDGET) {
+				r_upload_budget -= buffer.size();
+			}
+		}
+		if (!dirty_ranges.empty()) {
+			_update_buffer(r_upload_budget);
+		}
 	}
 	remote_size = buffer.size();
-	dirty_start = 0;
-	dirty_end = 0;
+}
+
+int64_t ComputeBuffer::get_pending_bytes() const {
+	int64_t pending_bytes = 0;
+	for (const auto& [start, end] : dirty_ranges) {
+		pending_bytes += end - start;
+	}
+	return pending_bytes;
 }
 
 int64_t ComputeBuffer::aligned_size(const int64_t size, const int64_t alignment) {
 	return alignment * ((size + (alignment - 1)) / alignment);
 }
 
-RID ComputeBuffer::_create_buffer() {
+int64_t ComputeBuffer::get_texel_size(const RenderingDevice::DataFormat format) {
+	switch (format) {
+		case RenderingDevice::DATA_FORMAT_R16_SFLOAT:
+		case RenderingDevice::DATA_FORMAT_R16_SINT:
+		case RenderingDevice::DATA_FORMAT_R16_UINT:
+			return 2;
+		case RenderingDevice::DATA_FORMAT_R32_SFLOAT:
+		case RenderingDevice::DATA_FORMAT_R32_SINT:
+		case RenderingDevice::DATA_FORMAT_R32_UINT:
+		case RenderingDevice::DATA_FORMAT_R16G16_SFLOAT:
+		case RenderingDevice::DATA_FORMAT_R16G16_SINT:
+		case RenderingDevice::DATA_FORMAT_R16G16_UINT:
+			return 4;
+		case RenderingDevice::DATA_FORMAT_R32G32_SFLOAT:
+		case RenderingDevice::DATA_FORMAT_R32G32_SINT:
+		case RenderingDevice::DATA_FORMAT_R32G32_UINT:
+		case RenderingDevice::DATA_FORMAT_R16G16B16A16_SFLOAT:
+		case RenderingDevice::DATA_FORMAT_R16G16B16A16_SINT:
+		case RenderingDevice::DATA_FORMAT_R16G16B16A16_UINT:
+			return 8;
+		case RenderingDevice::DATA_FORMAT_R32G32B32A32_SFLOAT:
+		case RenderingDevice::DATA_FORMAT_R32G32B32A32_SINT:
+		case RenderingDevice::DATA_FORMAT_R32G32B32A32_UINT:
+			return 16;
+		default:
+			return 0;
+	}
+}
+
+RID ComputeBuffer::_create_buffer(const bool with_data) {
+	const PackedByteArray initial_data = with_data ? buffer : PackedByteArray();
 	switch (type) {
 		case ComputeBufferType::CONSTANT_BUFFER:
-			return rendering_device->uniform_buffer_create(buffer.size(), buffer);
+			return rendering_device->uniform_buffer_create(buffer.size(), initial_data);
 		case ComputeBufferType::STORAGE_BUFFER:
-			return rendering_device->storage_buffer_create(buffer.size(), buffer);
-		case ComputeBufferType::TEXTURE_BUFFER:
-			// TODO: Format?
-			return rendering_device->texture_buffer_create(buffer.size() / 16, RenderingDevice::DATA_FORMAT_R32G32B32A32_SFLOAT, buffer);
+			// storage buffers may hold the arguments of ComputeShaderTask::dispatch_indirect
+			return rendering_device->storage_buffer_create(buffer.size(), initial_data, RenderingDevice::STORAGE_BUFFER_USAGE_DISPATCH_INDIRECT);
+		case ComputeBufferType::TEXTURE_BUFFER: {
+			const int64_t texel_size = get_texel_size(get_data_format());
+			ERR_FAIL_COND_V_MSG(texel_size <= 0, {}, String("Unsupported texture buffer format %s!") % static_cast<int64_t>(get_data_format()));
+			return rendering_device->texture_buffer_create(buffer.size() / texel_size, get_data_format(), initial_data);
+		}
 	}
 	ERR_FAIL_V_MSG({}, String("Invalid buffer type %s!") % static_cast<int64_t>(type));
 }
 
-void ComputeBuffer::_update_buffer() {
-	if (type == ComputeBufferType::TEXTURE_BUFFER) {
-		// TODO: buffer_update and texture_update both fail?
-		rid = rendering_device->texture_buffer_create(buffer.size() / 16, RenderingDevice::DATA_FORMAT_R32G32B32A32_SFLOAT, buffer);
-	} else {
-		rendering_device->buffer_update(rid, dirty_start, Math::min(dirty_end - dirty_start, buffer.size()), buffer);
+void ComputeBuffer::_update_buffer(int64_t& r_upload_budget) {
+	// texture buffers are updated in place as well, buffer_update writes into their backing storage
+	auto range = dirty_ranges.begin();
+	while (range != dirty_ranges.end() && r_upload_budget > 0) {
+		const int64_t start = range->first;
+		const int64_t end = Math::min(range->second, start + r_upload_budget);
+		// buffer_update reads from the start of the array it is given
+		rendering_device->buffer_update(rid, start, end - start, buffer.slice(start, end));
+		if (r_upload_budget != UNLIMITED_UPLOAD_BUDGET) {
+			r_upload_budget -= end - start;
+		}
+		if (end < range->second) {
+			// the rest of the range is uploaded by a later flush
+			range->first = end;
+			break;
+		}
+		++range;
+	}
+	dirty_ranges.erase(dirty_ranges.begin(), range);
+}
+
+void ComputeBuffer::_flush_ring() {
+	if (ring.empty()) {
+		ERR_FAIL_COND(buffer.is_empty());
+		pool = ConstantBufferPool::get_for(rendering_device);
+		ERR_FAIL_NULL(pool);
+		ring.push_back(pool->acquire(buffer));
+		ring_index = 0;
+		return;
+	}
+	if (dirty_ranges.empty())
+		return;
+
+	const uint64_t frame = Engine::get_singleton()->get_frames_drawn();
+	if (frame != ring_frame) {
+		ring_frame = frame;
+		ring_frame_updates = 0;
+	}
+	++ring_frame_updates;
+	// every update of this frame needs a buffer of its own, buffers used in earlier frames can be reused
+	if (ring_frame_updates >= ring.size() && ring.size() < MAX_CONSTANT_BUFFER_RING_SIZE) {
+		ring.insert(ring.begin() + static_cast<int64_t>(ring_index) + 1, pool->acquire(buffer));
+		++ring_index;
+		return;
+	}
+	// past the maximum ring size, updates wrap around and serialize with the dispatches still reading the buffer
+	ring_index = (ring_index + 1) % ring.size();
+	rendering_device->buffer_update(ring[ring_index].rid, 0, buffer.size(), buffer);
+}
+
+void ComputeBuffer::_shrink_to_fit() {
+	// only shrinking once the size falls below capacity / factor^2 keeps a size that oscillates around a boundary from reallocating every flush
+	const double factor = Math::max(get_growth_factor(), 1.0);
+	if (factor <= 1.0 || buffer.size() <= MIN_CAPACITY || size * factor * factor >= buffer.size())
+		return;
+	const int64_t alignment = get_alignment();
+	const int64_t capacity = Math::max<int64_t>(MIN_CAPACITY, size * factor);
+	buffer.resize(alignment > 0 ? aligned_size(capacity, alignment) : capacity);
+}
+
+void ComputeBuffer::_mark_dirty(const int64_t start, const int64_t end) {
+	const int64_t gap = Math::max<int64_t>(get_dirty_merge_gap(), 0);
+	// first range that ends close enough to start to be merged with it
+	auto first = std::lower_bound(dirty_ranges.begin(), dirty_ranges.end(), start - gap, [](const std::pair<int64_t, int64_t>& range, const int64_t value) {
+		return range.second < value;
+	});
+	auto last = first;
+	int64_t merged_start = start;
+	int64_t merged_end = end;
+	while (last != dirty_ranges.end() && last->first <= end + gap) {
+		merged_start = Math::min(merged_start, last->first);
+		merged_end = Math::max(merged_end, last->second);
+		++last;
+	}
+	first = dirty_ranges.erase(first, last);
+	dirty_ranges.emplace(first, merged_start, merged_end);
+
+	if (dirty_ranges.size() > MAX_DIRTY_RANGES) {
+		auto closest = dirty_ranges.begin();
+		for (auto it = dirty_ranges.begin(); it + 1 != dirty_ranges.end(); ++it) {
+			if ((it + 1)->first - it->second < (closest + 1)->first - closest->second) {
+				closest = it;
+			}
+		}
+		closest->second = (closest + 1)->second;
+		dirty_ranges.erase(closest + 1);
 	}
 }
 
 RID ComputeBuffer::get_rid() const {
+	if (type == ComputeBufferType::CONSTANT_BUFFER) {
+		return ring.empty() ? RID() : ring[ring_index].rid;
+	}
 	return rid;
 }
 
 GET_SET_PROPERTY_IMPL(ComputeBuffer, PackedByteArray, buffer)
 GET_SET_PROPERTY_IMPL(ComputeBuffer, int64_t, alignment)
 GET_SET_PROPERTY_IMPL(ComputeBuffer, bool, is_fixed_size)
+GET_SET_PROPERTY_IMPL(ComputeBuffer, double, growth_factor)
+GET_SET_PROPERTY_IMPL(ComputeBuffer, int64_t, dirty_merge_gap)
+GET_SET_PROPERTY_IMPL(ComputeBuffer, RenderingDevice::DataFormat, data_format)
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include "binding_macros.h"
 #include "compute_shader_shape.h"
+#include "constant_buffer_pool.h"
 #include "rids.h"
 
 enum class ComputeBufferType {
@@ -15,27 +19,65 @@ class ComputeBuffer {
     GET_SET_PROPERTY(godot::PackedByteArray, buffer)
     GET_SET_PROPERTY(int64_t, alignment)
     GET_SET_PROPERTY(bool, is_fixed_size)
+    // capacity multiplier applied when an unbounded buffer outgrows its allocation
+    GET_SET_PROPERTY(double, growth_factor)
+    // dirty ranges closer than this many bytes are uploaded together, as every buffer_update has a fixed cost
+    GET_SET_PROPERTY(int64_t, dirty_merge_gap)
+    // texel format of texture buffers
+    GET_SET_PROPERTY(godot::RenderingDevice::DataFormat, data_format)
 
 public:
 	ComputeBuffer(godot::RenderingDevice* p_rendering_device, ComputeBufferType p_type);
+	ComputeBuffer(const ComputeBuffer&) = delete;
+	ComputeBuffer& operator=(const ComputeBuffer&) = delete;
+	~ComputeBuffer();
 
 	godot::RID get_rid() const;
 
 	void write(int64_t offset, std::span<const uint8_t> data);
     void write(int64_t offset, int64_t size, const godot::Variant& data, ShaderTypeLayoutShape::MatrixLayout matrix_layout = ShaderTypeLayoutShape::MatrixLayout::ROW_MAJOR);
-    void set_size(int64_t size);
-    void flush();
+    // logical size in bytes, the allocation only grows geometrically and shrinks once the size falls well below it
+    [[nodiscard]] int64_t get_size() const { return size; }
+    void set_size(int64_t p_size);
+    void reserve(int64_t capacity);
+    // uploads at most r_upload_budget bytes and deducts them from it, anything past it stays pending for later flushes
+    void flush(int64_t& r_upload_budget);
+    // bytes written but not yet uploaded by flush, only non-zero after a flush that ran out of upload budget
+    [[nodiscard]] int64_t get_pending_bytes() const;
 
     static int64_t aligned_size(int64_t size, int64_t alignment);
+    // bytes per texel of the formats typed buffers are reflected with, or 0 for any other format
+    static int64_t get_texel_size(godot::RenderingDevice::DataFormat format);
+
+    // upper bound on the constant buffers a single ComputeBuffer rotates through within a frame
+    static constexpr size_t MAX_CONSTANT_BUFFER_RING_SIZE = 8;
+    static constexpr double DEFAULT_GROWTH_FACTOR = 2.0;
+    // the smallest allocation of an unbounded buffer, as buffers cannot be 0 bytes
+    static constexpr int64_t MIN_CAPACITY = 256;
+    static constexpr int64_t UNLIMITED_UPLOAD_BUDGET = INT64_MAX;
+    static constexpr int64_t DEFAULT_DIRTY_MERGE_GAP = 256;
+    // past this many ranges, the closest ones are merged regardless of the gap between them
+    static constexpr size_t MAX_DIRTY_RANGES = 16;
 
 private:
 	godot::RenderingDevice* rendering_device;
 	UniqueRID<godot::RenderingDevice> rid;
 	ComputeBufferType type;
+	// constant buffers are updated by switching to another buffer of a ring, as earlier dispatches of the frame may still read the current one
+	// the buffers come from the device's ConstantBufferPool and go back to it once this is destroyed
+	ConstantBufferPool* pool = nullptr;
+	std::vector<ConstantBufferPool::Allocation> ring{};
+	size_t ring_index = 0;
+	uint64_t ring_frame = 0;
+	size_t ring_frame_updates = 0;
+    int64_t size = 0;
     int64_t remote_size = 0;
-    int64_t dirty_start = 0;
-    int64_t dirty_end = 0;
+    // sorted, disjoint [start, end) byte ranges not yet uploaded
+    std::vector<std::pair<int64_t, int64_t>> dirty_ranges{};
 
-	godot::RID _create_buffer();
-	void _update_buffer();
+	godot::RID _create_buffer(bool with_data = true);
+	void _update_buffer(int64_t& r_upload_budget);
+	void _flush_ring();
+	void _shrink_to_fit();
+	void _mark_dirty(int64_t start, int64_t end);
 };
\ No newline at end of file
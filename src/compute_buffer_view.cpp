@@ -0,0 +1,23 @@
+#include "compute_buffer_view.h"
+
+using namespace godot;
+
+void ComputeBufferView::_bind_methods() {
+	ClassDB::bind_static_method(get_class_static(), D_METHOD("create", "buffer", "offset", "size"), &ComputeBufferView::create, DEFVAL(0), DEFVAL(0));
+	BIND_GET_SET(ComputeBufferView, buffer, Variant::RID)
+	BIND_GET_SET(ComputeBufferView, offset, Variant::INT, PROPERTY_HINT_RANGE, "0,1,or_greater,suffix:B")
+	BIND_GET_SET(ComputeBufferView, size, Variant::INT, PROPERTY_HINT_RANGE, "0,1,or_greater,suffix:B")
+}
+
+Ref<ComputeBufferView> ComputeBufferView::create(const RID& p_buffer, const int64_t p_offset, const int64_t p_size) {
+	Ref<ComputeBufferView> view{};
+	view.instantiate();
+	view->set_buffer(p_buffer);
+	view->set_offset(p_offset);
+	view->set_size(p_size);
+	return view;
+}
+
+GET_SET_PROPERTY_IMPL(ComputeBufferView, RID, buffer)
+GET_SET_PROPERTY_IMPL(ComputeBufferView, int64_t, offset)
+GET_SET_PROPERTY_IMPL(ComputeBufferView, int64_t, size)
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "godot_cpp/classes/resource.hpp"
+
+#include "binding_macros.h"
+
+class ComputeBufferView : public godot::Resource {
+	GDCLASS(ComputeBufferView, Resource);
+
+	GET_SET_PROPERTY(godot::RID, buffer)
+	GET_SET_PROPERTY(int64_t, offset)
+	GET_SET_PROPERTY(int64_t, size)
+
+protected:
+	static void _bind_methods();
+
+public:
+	ComputeBufferView() = default;
+
+	static godot::Ref<ComputeBufferView> create(const godot::RID& p_buffer, int64_t p_offset = 0, int64_t p_size = 0);
+};
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "compute_shader_cursor.h"
 
 #include "godot_cpp/classes/engine.hpp"
@@ -9,6 +11,7 @@
 
 #include "attributes.h"
 #include "compute_buffer.h"
+#include "compute_buffer_view.h"
 #include "sampler_cache.h"
 #include "variant_serializer.h"
 
@@ -43,18 +46,14 @@ ComputeShaderObject::ComputeShaderObject(RenderingDevice* p_rendering_device, Sa
 	ERR_FAIL_NULL(p_shape);
 	// TODO: Surely you can read directly if this should start a new space from the reflection API, but I can't find it
 	bool has_only_parameter_blocks = true;
-	const TypedArray<Dictionary> bindings = p_shape->get_bindings();
-	for (int64_t binding_range_index = 0; binding_range_index < bindings.size(); binding_range_index++) {
-		const auto binding = BindingRange::from_dict(bindings[binding_range_index]);
+	const std::vector<BindingRange>& bindings = p_shape->get_binding_ranges();
+	for (int64_t binding_range_index = 0; binding_range_index < static_cast<int64_t>(bindings.size()); binding_range_index++) {
+		const BindingRange& binding = bindings[binding_range_index];
 		has_only_parameter_blocks = has_only_parameter_blocks && binding.type == ShaderTypeLayoutShape::BindingType::PARAMETER_BLOCK;
 		if (binding.type == ShaderTypeLayoutShape::BindingType::PUSH_CONSTANT) {
 			push_constants.resize(ComputeBuffer::aligned_size(binding.size, _get_push_constant_alignment()));
 		} else if (binding.uniform_type && binding.leaf_shape.is_null()) {
-			Ref<RDUniform> uniform{};
-			uniform.instantiate();
-			uniform->set_binding(first_slot_index + binding.slot_offset);
-			uniform->set_uniform_type(*binding.uniform_type);
-			uniforms.set(binding_range_index, uniform);
+			uniforms.emplace(binding_range_index, UniformSlot{ first_slot_index + binding.slot_offset, *binding.uniform_type, {} });
 		}
 	}
 	if (has_only_parameter_blocks) {
@@ -64,7 +63,14 @@ ComputeShaderObject::ComputeShaderObject(RenderingDevice* p_rendering_device, Sa
 
 void ComputeShaderObject::write_resource(const ComputeShaderOffset& offset, const Variant& data) {
 	if (const RDUniform* uniform = Object::cast_to<RDUniform>(data)) {
-		uniforms.set(offset.binding_range_offset, uniform);
+		UniformSlot slot{ uniform->get_binding(), uniform->get_uniform_type(), {} };
+		for (const RID rid : uniform->get_ids()) {
+			slot.ids.push_back(rid);
+		}
+		if (UniformSlot& current = uniforms[offset.binding_range_offset]; current != slot) {
+			current = std::move(slot);
+			++resource_version;
+		}
 		return;
 	}
 
@@ -74,15 +80,22 @@ void ComputeShaderObject::write_resource(const ComputeShaderOffset& offset, cons
 	ERR_FAIL_COND(binding->binding_count <= 0);
 
 	const auto uniform_type = *binding->uniform_type;
-	const Ref<RDUniform> uniform = uniforms.get(offset.binding_range_offset, {});
-	ERR_FAIL_NULL(uniform);
-	TypedArray<RID> rids = uniform->get_ids();
-	uniform->clear_ids();
+	const auto slot = uniforms.find(offset.binding_range_offset);
+	ERR_FAIL_COND(slot == uniforms.end());
+	std::vector<RID>& rids = slot->second.ids;
+	bool changed = false;
+	const auto set_rid = [&rids, &changed](const size_t index, const RID& rid) {
+		if (rids[index] != rid) {
+			rids[index] = rid;
+			changed = true;
+		}
+	};
 
 	const int64_t elements_per_binding = uniform_type == RenderingDevice::UniformType::UNIFORM_TYPE_SAMPLER_WITH_TEXTURE ? 2 : 1;
 
-	if (rids.size() != binding->binding_count * elements_per_binding) {
+	if (static_cast<int64_t>(rids.size()) != binding->binding_count * elements_per_binding) {
 		rids.resize(binding->binding_count * elements_per_binding);
+		changed = true;
 	}
 
 	ERR_FAIL_INDEX(offset.element_offset, binding->binding_count);
@@ -90,28 +103,34 @@ void ComputeShaderObject::write_resource(const ComputeShaderOffset& offset, cons
 	const Variant data_or_default = data == Variant{} ? _get_default_value(uniform_type) : data;
 	if (uniform_type == RenderingDevice::UniformType::UNIFORM_TYPE_UNIFORM_BUFFER || uniform_type == RenderingDevice::UniformType::UNIFORM_TYPE_STORAGE_BUFFER) {
 		buffers.erase(offset.binding_range_offset);
-		rids[offset.element_offset] = _get_resource_rid(data_or_default);
+		// the rendering device can only bind whole buffers, so the view's range only applies to readback
+		if (const ComputeBufferView* view = Object::cast_to<ComputeBufferView>(data_or_default)) {
+			buffer_views[offset.binding_range_offset] = { view->get_offset(), view->get_size() };
+		} else {
+			buffer_views.erase(offset.binding_range_offset);
+		}
+		set_rid(offset.element_offset, _get_resource_rid(data_or_default));
 	} else if (uniform_type == RenderingDevice::UniformType::UNIFORM_TYPE_SAMPLER_WITH_TEXTURE && data_or_default.get_type() != Variant::Type::ARRAY) {
 		if (const Object* sampler = data_or_default; sampler && sampler->is_class(RDSamplerState::get_class_static())) {
 			const Variant default_texture = _get_default_value(RenderingDevice::UniformType::UNIFORM_TYPE_TEXTURE);
-			rids[offset.element_offset * 2] = _get_resource_rid(sampler);
-			rids[offset.element_offset * 2 + 1] = _get_resource_rid(default_texture);
+			set_rid(offset.element_offset * 2, _get_resource_rid(sampler));
+			set_rid(offset.element_offset * 2 + 1, _get_resource_rid(default_texture));
 		} else {
 			const Variant default_sampler = _get_default_value(RenderingDevice::UniformType::UNIFORM_TYPE_SAMPLER);
-			rids[offset.element_offset * 2] = _get_resource_rid(default_sampler);
-			rids[offset.element_offset * 2 + 1] = _get_resource_rid(data_or_default);
+			set_rid(offset.element_offset * 2, _get_resource_rid(default_sampler));
+			set_rid(offset.element_offset * 2 + 1, _get_resource_rid(data_or_default));
 		}
 	} else if (data_or_default.get_type() == Variant::Type::ARRAY) {
 		const Array array = data_or_default;
-		for (int64_t i = 0; i < array.size() && offset.element_offset + i < rids.size(); i++) {
-			rids[offset.element_offset + i] = _get_resource_rid(array[i]);
+		for (int64_t i = 0; i < array.size() && offset.element_offset + i < static_cast<int64_t>(rids.size()); i++) {
+			set_rid(offset.element_offset + i, _get_resource_rid(array[i]));
 		}
 	} else {
-		rids[offset.element_offset] = _get_resource_rid(data_or_default);
+		set_rid(offset.element_offset, _get_resource_rid(data_or_default));
 	}
 
-	for (const RID rid : rids) {
-		uniform->add_id(rid);
+	if (changed) {
+		++resource_version;
 	}
 }
 
@@ -124,7 +143,7 @@ void ComputeShaderObject::write_bytes(const ComputeShaderOffset& offset, const s
 	} else {
 		ComputeBuffer* buffer = _get_or_create_buffer(offset.binding_range_offset);
 		ERR_FAIL_NULL(buffer);
-		if (!buffer->get_is_fixed_size() && offset.byte_offset + data.size() > buffer->get_buffer().size()) {
+		if (!buffer->get_is_fixed_size() && offset.byte_offset + static_cast<int64_t>(data.size()) > buffer->get_size()) {
 			buffer->set_size(offset.byte_offset + data.size());
 		}
 		buffer->write(offset.byte_offset, data);
@@ -141,73 +160,197 @@ void ComputeShaderObject::write_bytes(const ComputeShaderOffset& offset, const V
 	} else {
 		ComputeBuffer* buffer = _get_or_create_buffer(offset.binding_range_offset);
 		ERR_FAIL_NULL(buffer);
-		if (!buffer->get_is_fixed_size() && offset.byte_offset + size > buffer->get_buffer().size()) {
+		if (!buffer->get_is_fixed_size() && offset.byte_offset + size > buffer->get_size()) {
 			buffer->set_size(offset.byte_offset + size);
 		}
 		buffer->write(offset.byte_offset, size, data, matrix_layout);
 	}
 }
 
-void ComputeShaderObject::flush_buffers() {
+void ComputeShaderObject::set_buffer_size(const ComputeShaderOffset& offset, const int64_t size) {
+	const auto binding_range = _get_binding_range(offset.binding_range_offset);
+	ERR_FAIL_COND(!binding_range);
+	if (binding_range->type == ShaderTypeLayoutShape::BindingType::PUSH_CONSTANT)
+		return;
+	ComputeBuffer* buffer = _get_or_create_buffer(offset.binding_range_offset);
+	ERR_FAIL_NULL(buffer);
+	if (!buffer->get_is_fixed_size()) {
+		buffer->set_size(offset.byte_offset + size);
+	}
+}
+
+int64_t ComputeShaderObject::get_buffer_size(const ComputeShaderOffset& offset) const {
+	const auto it = buffers.find(offset.binding_range_offset);
+	if (it == buffers.end())
+		return 0;
+	return Math::max<int64_t>(0, it->second->get_size() - offset.byte_offset);
+}
+
+void ComputeShaderObject::flush_buffers(int64_t& r_upload_budget) {
 	for (auto& [binding_range_index, buffer] : buffers) {
-		buffer->flush();
-		const Ref<RDUniform> buffer_uniform = uniforms.get(binding_range_index, {});
-		if (buffer_uniform.is_valid()) {
-			buffer_uniform->clear_ids();
-			buffer_uniform->add_id(buffer->get_rid());
+		buffer->flush(r_upload_budget);
+		const auto slot = uniforms.find(binding_range_index);
+		if (slot == uniforms.end())
+			continue;
+		// only a reallocated buffer changes the uniform
+		if (std::vector<RID>& ids = slot->second.ids; ids.size() != 1 || ids.front() != buffer->get_rid()) {
+			ids.assign(1, buffer->get_rid());
+			++resource_version;
 		}
 	}
 	for (auto it = subobjects.begin(); it != subobjects.end(); ++it) {
-		it->second->flush_buffers();
+		it->second->flush_buffers(r_upload_budget);
 	}
 }
 
-ComputeShaderObject::DescriptorSets ComputeShaderObject::get_descriptor_sets() {
-	DescriptorSets result{};
-	uint64_t next_space_index = 0;
-	get_descriptor_sets(result, next_space_index);
-	return result;
+int64_t ComputeShaderObject::get_pending_upload_bytes() const {
+	int64_t pending_bytes = 0;
+	for (const auto& [_, buffer] : buffers) {
+		pending_bytes += buffer->get_pending_bytes();
+	}
+	for (const auto& [_, subobject] : subobjects) {
+		pending_bytes += subobject->get_pending_upload_bytes();
+	}
+	return pending_bytes;
+}
+
+void ComputeShaderObject::get_pending_upload_rids(std::vector<RID>& r_rids) const {
+	for (const auto& [_, buffer] : buffers) {
+		if (buffer->get_pending_bytes() > 0) {
+			r_rids.push_back(buffer->get_rid());
+		}
+	}
+	for (const auto& [_, subobject] : subobjects) {
+		subobject->get_pending_upload_rids(r_rids);
+	}
 }
 
-uint64_t ComputeShaderObject::get_descriptor_sets(DescriptorSets& descriptor_sets, uint64_t& next_space_index) {
-	return get_descriptor_sets(descriptor_sets, next_space_index, next_space_index);
+uint64_t ComputeShaderObject::get_descriptor_layout(DescriptorLayout& layout, uint64_t& next_space_index) {
+	return get_descriptor_layout(layout, next_space_index, next_space_index);
 }
 
-uint64_t ComputeShaderObject::get_descriptor_sets(DescriptorSets& descriptor_sets, const uint64_t current_space_index, uint64_t& next_space_index) {
+uint64_t ComputeShaderObject::get_descriptor_layout(DescriptorLayout& layout, const uint64_t current_space_index, uint64_t& next_space_index) {
 	const uint64_t active_space_index = owns_binding_space ? next_space_index++ : current_space_index;
-	descriptor_sets[active_space_index].append_array(uniforms.values());
+	layout[active_space_index].push_back(this);
 	ERR_FAIL_NULL_V(shape, active_space_index);
-	for (int64_t i = 0; i < shape->get_bindings().size(); i++) {
+	for (int64_t i = 0; i < static_cast<int64_t>(shape->get_binding_ranges().size()); i++) {
 		if (ComputeShaderObject* subobject = get_or_create_subobject(i)) {
-			subobject->get_descriptor_sets(descriptor_sets, active_space_index, next_space_index);
+			subobject->get_descriptor_layout(layout, active_space_index, next_space_index);
+		}
+	}
+	return active_space_index;
+}
+
+void ComputeShaderObject::append_uniforms(std::vector<const UniformSlot*>& r_uniforms) const {
+	for (const auto& [binding_range_index, uniform] : uniforms) {
+		r_uniforms.push_back(&uniform);
+	}
+}
+
+uint64_t ComputeShaderObject::get_resource_accesses(std::vector<ResourceAccess>& accesses, uint64_t& next_space_index) {
+	return get_resource_accesses(accesses, next_space_index, next_space_index);
+}
+
+uint64_t ComputeShaderObject::get_resource_accesses(std::vector<ResourceAccess>& accesses, const uint64_t current_space_index, uint64_t& next_space_index) {
+	const uint64_t active_space_index = owns_binding_space ? next_space_index++ : current_space_index;
+	ERR_FAIL_NULL_V(shape, active_space_index);
+	for (const auto& [binding_range_index, uniform] : uniforms) {
+		const auto binding_range = _get_binding_range(binding_range_index);
+		if (!binding_range)
+			continue;
+		const bool is_mutable = static_cast<int64_t>(binding_range->ext_binding_type()) & static_cast<int64_t>(ShaderTypeLayoutShape::BindingType::MUTABLE_FLAG);
+		const bool is_writable = is_mutable || binding_range->uniform_type == RenderingDevice::UniformType::UNIFORM_TYPE_IMAGE;
+		for (const RID& rid : uniform.ids) {
+			if (rid.is_valid()) {
+				accesses.push_back(ResourceAccess{ active_space_index, rid, is_writable });
+			}
+		}
+	}
+	for (int64_t i = 0; i < static_cast<int64_t>(shape->get_binding_ranges().size()); i++) {
+		if (ComputeShaderObject* subobject = get_or_create_subobject(i)) {
+			subobject->get_resource_accesses(accesses, active_space_index, next_space_index);
 		}
 	}
 	return active_space_index;
 }
 
 TypedArray<RID> ComputeShaderObject::get_rids(const ComputeShaderOffset& offset) const {
-	const Ref<RDUniform> uniform = uniforms.get(offset.binding_range_offset, {});
-	ERR_FAIL_NULL_V(uniform, {});
-	ERR_FAIL_COND_V(uniform->get_ids().is_empty(), {});
-	return uniform->get_ids();
+	const auto slot = uniforms.find(offset.binding_range_offset);
+	ERR_FAIL_COND_V(slot == uniforms.end(), {});
+	ERR_FAIL_COND_V(slot->second.ids.empty(), {});
+	TypedArray<RID> rids{};
+	for (const RID& rid : slot->second.ids) {
+		rids.push_back(rid);
+	}
+	return rids;
 }
 
 PackedByteArray ComputeShaderObject::get_buffer_data(const ComputeShaderOffset& offset, const uint32_t size_bytes) const {
-	const Ref<RDUniform> uniform = uniforms.get(offset.binding_range_offset, {});
-	ERR_FAIL_NULL_V(uniform, {});
-	ERR_FAIL_COND_V(uniform->get_ids().is_empty(), {});
-	const RID buffer_rid = uniform->get_ids().front();
+	const auto slot = uniforms.find(offset.binding_range_offset);
+	ERR_FAIL_COND_V(slot == uniforms.end(), {});
+	ERR_FAIL_COND_V(slot->second.ids.empty(), {});
+	const RID buffer_rid = slot->second.ids.front();
 	ERR_FAIL_NULL_V(rendering_device, {});
-	return rendering_device->buffer_get_data(buffer_rid, offset.byte_offset, size_bytes);
+	const auto range = _get_buffer_range(offset, size_bytes);
+	if (!range)
+		return {};
+	const auto [byte_offset, size] = *range;
+	if (size == BUFFER_END) {
+		// a size of 0 reads the whole buffer regardless of the offset, so the rest is sliced off the full copy
+		const PackedByteArray data = rendering_device->buffer_get_data(buffer_rid);
+		return byte_offset > 0 ? data.slice(byte_offset) : data;
+	}
+	return rendering_device->buffer_get_data(buffer_rid, byte_offset, size);
 }
 
 Error ComputeShaderObject::get_buffer_data_async(const Callable& callback, const ComputeShaderOffset& offset, const uint32_t size_bytes) const {
-	const Ref<RDUniform> uniform = uniforms.get(offset.binding_range_offset, {});
-	ERR_FAIL_NULL_V(uniform, {});
-	ERR_FAIL_COND_V(uniform->get_ids().is_empty(), {});
-	const RID buffer_rid = uniform->get_ids().front();
+	const auto slot = uniforms.find(offset.binding_range_offset);
+	ERR_FAIL_COND_V(slot == uniforms.end(), {});
+	ERR_FAIL_COND_V(slot->second.ids.empty(), {});
+	const RID buffer_rid = slot->second.ids.front();
 	ERR_FAIL_NULL_V(rendering_device, {});
-	return rendering_device->buffer_get_data_async(buffer_rid, callback, offset.byte_offset, size_bytes);
+	const auto range = _get_buffer_range(offset, size_bytes);
+	if (!range) {
+		// nothing to read, answered the same way the device would, on a later frame
+		callback.call_deferred(PackedByteArray());
+		return OK;
+	}
+	const auto [byte_offset, size] = *range;
+	if (size == BUFFER_END) {
+		if (byte_offset == 0)
+			return rendering_device->buffer_get_data_async(buffer_rid, callback);
+		return rendering_device->buffer_get_data_async(buffer_rid, callable_mp_static(&ComputeShaderObject::_slice_buffer_data).bind(byte_offset, callback));
+	}
+	return rendering_device->buffer_get_data_async(buffer_rid, callback, byte_offset, size);
+}
+
+std::optional<std::pair<int64_t, int64_t>> ComputeShaderObject::_get_buffer_range(const ComputeShaderOffset& offset, const uint32_t size_bytes) const {
+	const auto view = buffer_views.find(offset.binding_range_offset);
+	if (view == buffer_views.end()) {
+		if (!buffers.contains(offset.binding_range_offset))
+			return std::make_pair(offset.byte_offset, size_bytes > 0 ? static_cast<int64_t>(size_bytes) : BUFFER_END);
+		// owned buffers are allocated with spare capacity, only the elements written so far are read back
+		const int64_t written = get_buffer_size(offset);
+		if (written <= 0)
+			return std::nullopt;
+		const int64_t read_size = size_bytes > 0 ? std::min<int64_t>(size_bytes, written) : written;
+		return std::make_pair(offset.byte_offset, read_size);
+	}
+	const auto [view_offset, view_size] = view->second;
+	// open-ended views extend to the end of the buffer
+	if (view_size <= 0)
+		return std::make_pair(view_offset + offset.byte_offset, size_bytes > 0 ? static_cast<int64_t>(size_bytes) : BUFFER_END);
+	ERR_FAIL_COND_V_MSG(offset.byte_offset > view_size, std::nullopt, String("Offset %s is beyond the end of the buffer view!") % offset.byte_offset);
+	// never read past the end of the view, even when a size is given
+	const int64_t remaining = view_size - offset.byte_offset;
+	if (remaining == 0)
+		return std::nullopt;
+	const int64_t read_size = size_bytes > 0 ? std::min<int64_t>(size_bytes, remaining) : remaining;
+	return std::make_pair(view_offset + offset.byte_offset, read_size);
+}
+
+void ComputeShaderObject::_slice_buffer_data(const PackedByteArray& data, const int64_t byte_offset, const Callable& callback) {
+	callback.call(data.slice(byte_offset));
 }
 
 ComputeShaderObject* ComputeShaderObject::get_or_create_subobject(const uint64_t binding_range_index) {
@@ -224,12 +367,9 @@ ComputeShaderObject* ComputeShaderObject::get_or_create_subobject(const uint64_t
 	return it->second.get();
 }
 
-std::optional<BindingRange> ComputeShaderObject::_get_binding_range(const int64_t binding_range_index) const {
-	ERR_FAIL_NULL_V(shape, std::nullopt);
-	const TypedArray<Dictionary> binding_ranges = shape->get_bindings();
-	ERR_FAIL_INDEX_V(binding_range_index, binding_ranges.size(), std::nullopt);
-	const Dictionary binding = binding_ranges[binding_range_index];
-	return BindingRange::from_dict(binding);
+const BindingRange* ComputeShaderObject::_get_binding_range(const int64_t binding_range_index) const {
+	ERR_FAIL_NULL_V(shape, nullptr);
+	return shape->get_binding_range(binding_range_index);
 }
 
 ComputeBuffer* ComputeShaderObject::_get_or_create_buffer(const int64_t binding_range_index) {
@@ -241,6 +381,8 @@ ComputeBuffer* ComputeShaderObject::_get_or_create_buffer(const int64_t binding_
 	if (const auto binding_range = _get_binding_range(binding_range_index)) {
 		if (binding_range->leaf_shape.is_valid())
 			return nullptr;
+		// a view bound earlier no longer describes the buffer that replaces it
+		buffer_views.erase(binding_range_index);
 		switch (binding_range->base_binding_type()) {
 			case ShaderTypeLayoutShape::BindingType::CONSTANT_BUFFER: {
 				auto [new_buffer_it, _] = buffers.try_emplace(binding_range_index, std::make_unique<ComputeBuffer>(rendering_device, ComputeBufferType::CONSTANT_BUFFER));
@@ -255,8 +397,16 @@ ComputeBuffer* ComputeShaderObject::_get_or_create_buffer(const int64_t binding_
 				const ComputeBufferType buffer_type = binding_range->uniform_type == RenderingDevice::UniformType::UNIFORM_TYPE_TEXTURE_BUFFER ? ComputeBufferType::TEXTURE_BUFFER : ComputeBufferType::STORAGE_BUFFER;
 				auto [new_buffer_it, _] = buffers.try_emplace(binding_range_index, std::make_unique<ComputeBuffer>(rendering_device, buffer_type));
 				ComputeBuffer& new_buffer = *new_buffer_it->second;
-				new_buffer.set_size(256); // TODO: Default sizing behavior?
 				new_buffer.set_is_fixed_size(false);
+				if (buffer_type == ComputeBufferType::TEXTURE_BUFFER) {
+					// shapes imported before formats were reflected keep the previous default
+					if (binding_range->data_format) {
+						new_buffer.set_data_format(*binding_range->data_format);
+					}
+					// whole texels only, as the texel count is derived from the size
+					new_buffer.set_alignment(ComputeBuffer::get_texel_size(new_buffer.get_data_format()));
+				}
+				new_buffer.reserve(ComputeBuffer::MIN_CAPACITY);
 				return &new_buffer;
 			}
 			default:
@@ -292,6 +442,9 @@ RID ComputeShaderObject::_get_resource_rid(const Variant& data) const {
 		ERR_FAIL_NULL_V(sampler_cache, {});
 		return sampler_cache->get_sampler(sampler);
 	}
+	if (const auto view = Object::cast_to<ComputeBufferView>(data)) {
+		return view->get_buffer();
+	}
 	return data;
 }
 
@@ -311,16 +464,79 @@ int64_t ComputeShaderObject::_get_push_constant_alignment() {
 	return alignment;
 }
 
+std::optional<ComputeShaderPathCache::ResolvedPath> ComputeShaderPathCache::get(const StringName& path) {
+	std::lock_guard lock(mutex);
+	if (const uint64_t version = AttributeRegistry::get_instance()->get_write_handlers_version(); version != write_handlers_version) {
+		lookup.clear();
+		entries.clear();
+		write_handlers_version = version;
+		return std::nullopt;
+	}
+	const auto it = lookup.find(path);
+	if (it == lookup.end())
+		return std::nullopt;
+	entries.splice(entries.begin(), entries, it->value);
+	return it->value->second;
+}
+
+void ComputeShaderPathCache::put(const StringName& path, ResolvedPath resolved) {
+	std::lock_guard lock(mutex);
+	if (const auto it = lookup.find(path); it != lookup.end()) {
+		it->value->second = std::move(resolved);
+		entries.splice(entries.begin(), entries, it->value);
+		return;
+	}
+	while (!entries.empty() && entries.size() >= capacity) {
+		lookup.erase(entries.back().first);
+		entries.pop_back();
+	}
+	entries.emplace_front(path, std::move(resolved));
+	lookup.insert(path, entries.begin());
+}
+
+void ComputeShaderPathCache::clear() {
+	std::lock_guard lock(mutex);
+	lookup.clear();
+	entries.clear();
+}
+
 ComputeShaderCursor ComputeShaderCursor::path(const StringName& path) const {
 	if (path.is_empty())
 		return *this;
+	// entering a subobject depends on the starting offset, so only paths from the root of an object are cached
+	if (!_is_at_root())
+		return _parse_path(path, nullptr);
+
+	ComputeShaderPathCache& path_cache = shape->get_path_cache();
+	if (const std::optional<ComputeShaderPathCache::ResolvedPath> resolved = path_cache.get(path)) {
+		ComputeShaderCursor result(*this);
+		for (const uint64_t binding_range_index : resolved->subobjects) {
+			result.object = result.object->get_or_create_subobject(binding_range_index);
+			ERR_FAIL_NULL_V(result.object, ComputeShaderCursor(nullptr));
+		}
+		result.offset = resolved->offset;
+		result.shape = resolved->shape;
+		result.write_handlers = resolved->write_handlers;
+		result.default_value = resolved->default_value;
+		return result;
+	}
+
+	std::vector<uint64_t> subobjects{};
+	const ComputeShaderCursor result = _parse_path(path, &subobjects);
+	if (result.object) {
+		path_cache.put(path, ComputeShaderPathCache::ResolvedPath{ std::move(subobjects), result.offset, result.shape, result.write_handlers, result.default_value });
+	}
+	return result;
+}
+
+ComputeShaderCursor ComputeShaderCursor::_parse_path(const StringName& path, std::vector<uint64_t>* r_subobjects) const {
 	const PackedStringArray parts = path.split("/");
 	ComputeShaderCursor current(*this);
 	for (const String& field_path : parts) {
 		if (field_path.is_empty())
 			continue;
 		const PackedStringArray element_parts = field_path.split(":");
-		current = current.field(element_parts[0]);
+		current = current._field(element_parts[0], r_subobjects);
 		for (int64_t i = 1; i < element_parts.size(); i++) {
 			const String& part = element_parts[i];
 			ERR_FAIL_COND_V_MSG(!part.is_valid_int(), ComputeShaderCursor(nullptr), String("Invalid path: \"%s\"") % path);
@@ -331,9 +547,13 @@ ComputeShaderCursor ComputeShaderCursor::path(const StringName& path) const {
 }
 
 ComputeShaderCursor ComputeShaderCursor::field(const StringName& field_name) const {
+	return _field(field_name, nullptr);
+}
+
+ComputeShaderCursor ComputeShaderCursor::_field(const StringName& field_name, std::vector<uint64_t>* r_subobjects) const {
 	ComputeShaderCursor result(*this);
 	ERR_FAIL_NULL_V(result.shape, ComputeShaderCursor(nullptr));
-	const std::optional<FieldShape> property = result.shape->field(field_name);
+	const FieldShape* property = result.shape->find_field(field_name);
 	ERR_FAIL_COND_V_MSG(!property, ComputeShaderCursor(nullptr), String("No such field '%s'!") % field_name);
 	const Ref<ShaderTypeLayoutShape> property_shape = property->shape;
 	ERR_FAIL_NULL_V(property_shape, ComputeShaderCursor(nullptr));
@@ -341,25 +561,23 @@ ComputeShaderCursor ComputeShaderCursor::field(const StringName& field_name) con
 	result.shape = property_shape;
 	result.offset += ComputeShaderOffset::from_field(*property);
 
-	result.write_handlers.clear();
-	const Dictionary attributes = property->user_attributes;
-	for (auto attribute_name : attributes.keys()) {
-		const Dictionary attribute_arguments = attributes[attribute_name];
-		if (const auto factory = AttributeRegistry::get_instance()->get_write_handler(attribute_name)) {
-			if (const auto handler = factory->factory(attribute_arguments, *property)) {
-				result.write_handlers.insert(WriteHandlerWithPriority{ handler, factory->priority });
-			}
-		}
-	}
+	result.write_handlers = shape->get_field_write_handlers(*property);
 	result.default_value = property->default_value;
 
 	if (ComputeShaderObject* subobject = result.object->get_or_create_subobject(result.offset.binding_range_offset)) {
+		if (r_subobjects) {
+			r_subobjects->push_back(result.offset.binding_range_offset);
+		}
 		result.object = subobject;
 		result.offset = {};
 	}
 	return result;
 }
 
+bool ComputeShaderCursor::_is_at_root() const {
+	return object && shape.is_valid() && shape == object->get_shape() && offset.binding_range_offset == 0 && offset.element_offset == 0 && offset.byte_offset == 0;
+}
+
 ComputeShaderCursor ComputeShaderCursor::element(const int64_t index) const {
 	const auto array_shape = Object::cast_to<ArrayTypeLayoutShape>(shape.ptr());
 	ERR_FAIL_NULL_V(array_shape, ComputeShaderCursor(nullptr));
@@ -372,6 +590,12 @@ ComputeShaderCursor ComputeShaderCursor::element(const int64_t index) const {
 	return result;
 }
 
+ComputeShaderCursor ComputeShaderCursor::with_context(const Object* p_context) const {
+	ComputeShaderCursor result(*this);
+	result.dispatch_context = p_context;
+	return result;
+}
+
 void ComputeShaderCursor::write_bytes(const std::span<const uint8_t>& data) const {
 	ERR_FAIL_NULL(object);
 	object->write_bytes(offset, data);
@@ -388,9 +612,11 @@ void ComputeShaderCursor::write_resource(const Variant& data) const {
 }
 
 void ComputeShaderCursor::write(Variant data) const {
-	for (const auto& [handler, _] : write_handlers) {
-		handler(data, dispatch_context);
-	}
+	apply_write_handlers(data, dispatch_context);
+	write_value(data);
+}
+
+void ComputeShaderCursor::write_value(const Variant& data) const {
 	switch (data.get_type()) {
 		case Variant::Type::PACKED_BYTE_ARRAY: {
 			const PackedByteArray& bytes = data;
@@ -404,6 +630,8 @@ void ComputeShaderCursor::write(Variant data) const {
 		default:
 			if (const Ref<RDUniform> uniform = data; uniform.is_valid()) {
 				write_resource(uniform);
+			} else if (Object::cast_to<ComputeBufferView>(data)) {
+				write_resource(data);
 			} else {
 				ERR_FAIL_NULL(shape);
 				shape->write_into(*this, data);
@@ -412,11 +640,38 @@ void ComputeShaderCursor::write(Variant data) const {
 	}
 }
 
+void ComputeShaderCursor::apply_write_handlers(Variant& data, const Object* context) const {
+	if (!write_handlers)
+		return;
+	for (const auto& handler : *write_handlers) {
+		handler(data, context);
+	}
+}
+
 TypedArray<RID> ComputeShaderCursor::get_rids() const {
 	ERR_FAIL_NULL_V(object, {});
 	return object->get_rids(offset);
 }
 
+void ComputeShaderCursor::set_buffer_size(const int64_t size) const {
+	ERR_FAIL_NULL(object);
+	object->set_buffer_size(offset, size);
+}
+
+int64_t ComputeShaderCursor::get_buffer_size() const {
+	ERR_FAIL_NULL_V(object, 0);
+	return object->get_buffer_size(offset);
+}
+
+int64_t ComputeShaderCursor::get_element_count() const {
+	if (const auto array_shape = Object::cast_to<ArrayTypeLayoutShape>(shape.ptr())) {
+		if (array_shape->get_element_count() || array_shape->get_stride() <= 0)
+			return array_shape->get_element_count();
+		return get_buffer_size() / array_shape->get_stride();
+	}
+	return get_buffer_size();
+}
+
 PackedByteArray ComputeShaderCursor::get_buffer_data() const {
 	ERR_FAIL_NULL_V(object, {});
 	ERR_FAIL_NULL_V(shape, {});
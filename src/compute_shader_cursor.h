@@ -1,16 +1,22 @@
 #pragma once
 
+#include <list>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <span>
+#include <vector>
 
 #include "godot_cpp/classes/placeholder_texture2d.hpp"
 #include "godot_cpp/classes/rd_sampler_state.hpp"
 #include "godot_cpp/classes/rd_uniform.hpp"
+#include "godot_cpp/templates/hash_map.hpp"
 
 #include "attributes.h"
 #include "compute_buffer.h"
 #include "compute_shader_shape.h"
+#include "uniform_set_cache.h"
 
 class SamplerCache;
 
@@ -25,6 +31,40 @@ struct ComputeShaderOffset {
     static ComputeShaderOffset from_field(const FieldShape& field);
 };
 
+// least recently used cache of cursor paths, so repeated lookups of the same path skip parsing
+class ComputeShaderPathCache {
+
+public:
+    struct ResolvedPath {
+        // binding range indices of the subobjects entered along the path, starting at the root object
+        std::vector<uint64_t> subobjects{};
+        // relative to the last subobject entered, or to the root if there is none
+        ComputeShaderOffset offset{};
+        godot::Ref<ShaderTypeLayoutShape> shape{};
+        std::shared_ptr<const FieldWriteHandlers> write_handlers{};
+        godot::Variant default_value{};
+    };
+
+    static constexpr size_t DEFAULT_CAPACITY = 64;
+
+    explicit ComputeShaderPathCache(size_t p_capacity = DEFAULT_CAPACITY) : capacity(p_capacity) {}
+
+    std::optional<ResolvedPath> get(const godot::StringName& path);
+    void put(const godot::StringName& path, ResolvedPath resolved);
+    void clear();
+
+private:
+    using Entry = std::pair<godot::StringName, ResolvedPath>;
+
+    size_t capacity;
+    // registry version the cached write handlers were resolved against
+    uint64_t write_handlers_version{};
+    // most recently used first
+    std::list<Entry> entries{};
+    godot::HashMap<godot::StringName, std::list<Entry>::iterator> lookup{};
+    std::mutex mutex{};
+};
+
 class ComputeShaderObject {
 
 private:
@@ -33,29 +73,53 @@ private:
     godot::Ref<ShaderTypeLayoutShape> shape{};
     godot::PackedByteArray push_constants{};
     std::unordered_map<uint64_t, std::unique_ptr<ComputeBuffer>> buffers{};
-    godot::Dictionary uniforms{};
+    // keyed by binding range index
+    std::map<uint64_t, UniformSlot> uniforms{};
     bool owns_binding_space{};
     int64_t first_slot_index{};
     std::unordered_map<uint64_t, std::unique_ptr<ComputeShaderObject>> subobjects{};
+    uint64_t resource_version{};
+    // byte ranges of buffers bound through a ComputeBufferView, keyed by binding range index
+    std::unordered_map<uint64_t, std::pair<int64_t, int64_t>> buffer_views{};
 
 public:
-    using DescriptorSets = std::map<uint64_t, godot::TypedArray<godot::Ref<godot::RDUniform>>>;
+    // objects whose uniforms make up each descriptor set, fixed once the objects are created
+    using DescriptorLayout = std::map<uint64_t, std::vector<ComputeShaderObject*>>;
+
+    struct ResourceAccess {
+        uint64_t space_index{};
+        godot::RID rid{};
+        bool is_writable{};
+    };
 
 	ComputeShaderObject(godot::RenderingDevice* p_rendering_device, SamplerCache* p_sampler_cache, const godot::Ref<ShaderTypeLayoutShape>& p_shape, bool p_owns_binding_space = true, int64_t p_first_slot_index = 0);
     virtual ~ComputeShaderObject() = default;
 
     [[nodiscard]] godot::Ref<ShaderTypeLayoutShape> get_shape() const { return shape; }
     [[nodiscard]] const godot::PackedByteArray& get_push_constants() const { return push_constants; }
+    // incremented whenever one of the resources bound by this object (not its subobjects) changes
+    [[nodiscard]] uint64_t get_resource_version() const { return resource_version; }
+    [[nodiscard]] const std::map<uint64_t, UniformSlot>& get_uniforms() const { return uniforms; }
 
     void write_resource(const ComputeShaderOffset& offset, const godot::Variant& data);
     void write_bytes(const ComputeShaderOffset& offset, const std::span<const uint8_t>& data);
     void write_bytes(const ComputeShaderOffset& offset, const godot::Variant& data, int64_t size, ShaderTypeLayoutShape::MatrixLayout matrix_layout);
 
-    void flush_buffers();
-
-	DescriptorSets get_descriptor_sets();
-	uint64_t get_descriptor_sets(DescriptorSets& descriptor_sets, uint64_t& next_space_index);
-	uint64_t get_descriptor_sets(DescriptorSets& descriptor_sets, uint64_t current_space_index, uint64_t& next_space_index);
+    // logical size of the buffer from offset on, unbounded buffers keep their allocation when they shrink
+    void set_buffer_size(const ComputeShaderOffset& offset, int64_t size);
+    [[nodiscard]] int64_t get_buffer_size(const ComputeShaderOffset& offset) const;
+
+    // buffers share r_upload_budget, see ComputeBuffer::flush
+    void flush_buffers(int64_t& r_upload_budget);
+    // bytes still to be streamed in by later flushes, and the buffers they belong to
+    [[nodiscard]] int64_t get_pending_upload_bytes() const;
+    void get_pending_upload_rids(std::vector<godot::RID>& r_rids) const;
+
+	uint64_t get_descriptor_layout(DescriptorLayout& layout, uint64_t& next_space_index);
+	uint64_t get_descriptor_layout(DescriptorLayout& layout, uint64_t current_space_index, uint64_t& next_space_index);
+	void append_uniforms(std::vector<const UniformSlot*>& r_uniforms) const;
+	uint64_t get_resource_accesses(std::vector<ResourceAccess>& accesses, uint64_t& next_space_index);
+	uint64_t get_resource_accesses(std::vector<ResourceAccess>& accesses, uint64_t current_space_index, uint64_t& next_space_index);
 	godot::TypedArray<godot::RID> get_rids(const ComputeShaderOffset& offset) const;
 	godot::PackedByteArray get_buffer_data(const ComputeShaderOffset& offset, uint32_t size_bytes = 0) const;
 	godot::Error get_buffer_data_async(const godot::Callable& callback, const ComputeShaderOffset& offset, uint32_t size_bytes = 0) const;
@@ -63,48 +127,64 @@ public:
     ComputeShaderObject* get_or_create_subobject(uint64_t binding_range_index);
 
 private:
-	std::optional<BindingRange> _get_binding_range(int64_t binding_range_index) const;
+	const BindingRange* _get_binding_range(int64_t binding_range_index) const;
     ComputeBuffer* _get_or_create_buffer(int64_t binding_range_index);
     [[nodiscard]] godot::RID _get_resource_rid(const godot::Variant& data) const;
+    // byte offset and size to read back, with a size of BUFFER_END for the rest of the buffer, or nothing for an empty range
+    [[nodiscard]] std::optional<std::pair<int64_t, int64_t>> _get_buffer_range(const ComputeShaderOffset& offset, uint32_t size_bytes) const;
+    static void _slice_buffer_data(const godot::PackedByteArray& data, int64_t byte_offset, const godot::Callable& callback);
 	[[nodiscard]] static int64_t _get_push_constant_alignment();
 
     [[nodiscard]] static godot::Variant _get_default_value(godot::RenderingDevice::UniformType type);
+
+    static constexpr int64_t BUFFER_END = -1;
 };
 
 class ComputeShaderCursor {
 
 private:
-    struct WriteHandlerWithPriority {
-        AttributeRegistry::WriteHandler handler{};
-        int64_t priority{};
-
-        bool operator<(const WriteHandlerWithPriority& other) const {
-            return priority > other.priority;
-        }
-    };
-
     ComputeShaderOffset offset{};
     ComputeShaderObject* object;
     godot::Ref<ShaderTypeLayoutShape> shape{};
     const godot::Object* dispatch_context;
 
-    std::multiset<WriteHandlerWithPriority> write_handlers{};
+    // owned by the parent struct shape, shared rather than copied along with the cursor
+    std::shared_ptr<const FieldWriteHandlers> write_handlers{};
     godot::Variant default_value{};
 
 public:
     explicit ComputeShaderCursor(ComputeShaderObject* p_object, const godot::Object* p_context = nullptr)
         : object(p_object), shape(object ? object->get_shape() : nullptr), dispatch_context(p_context) {}
 
+    [[nodiscard]] ComputeShaderObject* get_object() const { return object; }
+    [[nodiscard]] const ComputeShaderOffset& get_offset() const { return offset; }
+    [[nodiscard]] const godot::Ref<ShaderTypeLayoutShape>& get_shape() const { return shape; }
+    [[nodiscard]] bool has_write_handlers() const { return write_handlers && !write_handlers->empty(); }
+
 	ComputeShaderCursor path(const godot::StringName& path) const;
     [[nodiscard]] ComputeShaderCursor field(const godot::StringName& field_name) const;
     [[nodiscard]] ComputeShaderCursor element(int64_t index) const;
+    [[nodiscard]] ComputeShaderCursor with_context(const godot::Object* p_context) const;
 
 	void write_bytes(const std::span<const uint8_t>& data) const;
     void write_bytes(const godot::Variant& data, int64_t size, ShaderTypeLayoutShape::MatrixLayout matrix_layout = ShaderTypeLayoutShape::MatrixLayout::ROW_MAJOR) const;
     void write_resource(const godot::Variant& data) const;
     void write(godot::Variant data) const;
+    // writes without running the attribute write handlers of this cursor
+    void write_value(const godot::Variant& data) const;
+    void apply_write_handlers(godot::Variant& data, const godot::Object* context) const;
+    // bytes from the cursor to the end of the data written into its buffer
+    void set_buffer_size(int64_t size) const;
+    [[nodiscard]] int64_t get_buffer_size() const;
+    // elements written into an unbounded array, the element count of a fixed-size array, or the byte size of any other buffer
+    [[nodiscard]] int64_t get_element_count() const;
 
 	godot::TypedArray<godot::RID> get_rids() const;
 	godot::PackedByteArray get_buffer_data() const;
 	godot::Error get_buffer_data_async(const godot::Callable& callback) const;
+
+private:
+    [[nodiscard]] ComputeShaderCursor _parse_path(const godot::StringName& path, std::vector<uint64_t>* r_subobjects) const;
+    [[nodiscard]] ComputeShaderCursor _field(const godot::StringName& field_name, std::vector<uint64_t>* r_subobjects) const;
+    [[nodiscard]] bool _is_at_root() const;
 };
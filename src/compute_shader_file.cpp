@@ -11,6 +11,7 @@ void ComputeShaderFile::_bind_methods() {
 	BIND_GET_SET_RESOURCE_ARRAY(ComputeShaderFile, kernels, ComputeShaderKernel)
 	BIND_GET_SET(ComputeShaderFile, base_error, Variant::STRING)
 	BIND_GET_SET_RESOURCE(ComputeShaderFile, parameters, StructTypeLayoutShape);
+	BIND_GET_SET(ComputeShaderFile, autowarm, Variant::BOOL)
 	ClassDB::bind_method(D_METHOD("set_bytecode", "bytecode", "version", "kernel_index"), &ComputeShaderFile::set_bytecode, DEFVAL(StringName("")), DEFVAL(0));
 	ClassDB::bind_method(D_METHOD("get_spirv", "version", "kernel_index"), &ComputeShaderFile::get_spirv, DEFVAL(StringName("")), DEFVAL(0));
 	ClassDB::bind_method(D_METHOD("get_version_list", "kernel_index"), &ComputeShaderFile::get_version_list, DEFVAL(0));
@@ -47,3 +48,4 @@ String ComputeShaderFile::get_godot_version_string() {
 GET_SET_PROPERTY_IMPL(ComputeShaderFile, TypedArray<ComputeShaderKernel>, kernels)
 GET_SET_PROPERTY_IMPL(ComputeShaderFile, String, base_error)
 GET_SET_PROPERTY_IMPL(ComputeShaderFile, Ref<StructTypeLayoutShape>, parameters);
+GET_SET_PROPERTY_IMPL(ComputeShaderFile, bool, autowarm)
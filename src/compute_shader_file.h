@@ -13,6 +13,7 @@ class ComputeShaderFile : public godot::Resource {
 	GET_SET_PROPERTY(godot::TypedArray<ComputeShaderKernel>, kernels)
 	GET_SET_PROPERTY(godot::String, base_error)
 	GET_SET_PROPERTY(godot::Ref<StructTypeLayoutShape>, parameters)
+	GET_SET_PROPERTY(bool, autowarm)
 
 protected:
 	static void _bind_methods();
@@ -1,5 +1,11 @@
 #include "compute_shader_kernel.h"
 
+#include "godot_cpp/classes/dir_access.hpp"
+#include "godot_cpp/classes/engine.hpp"
+#include "godot_cpp/classes/file_access.hpp"
+#include "godot_cpp/classes/rendering_server.hpp"
+#include "godot_cpp/templates/hashfuncs.hpp"
+
 using namespace godot;
 
 void ComputeShaderKernel::_bind_methods() {
@@ -10,6 +16,8 @@ void ComputeShaderKernel::_bind_methods() {
 	BIND_GET_SET(ComputeShaderKernel, space_offset, Variant::INT);
 	BIND_GET_SET(ComputeShaderKernel, slot_offset, Variant::INT);
 	BIND_GET_SET_RESOURCE(ComputeShaderKernel, spirv, RDShaderSPIRV);
+	BIND_GET_SET(ComputeShaderKernel, bytecode, Variant::PACKED_BYTE_ARRAY, PROPERTY_HINT_NONE, "", PROPERTY_USAGE_STORAGE);
+	BIND_GET_SET(ComputeShaderKernel, bytecode_key, Variant::STRING, PROPERTY_HINT_NONE, "", PROPERTY_USAGE_STORAGE);
 	BIND_GET_SET_RESOURCE(ComputeShaderKernel, parameters, StructTypeLayoutShape);
 }
 
@@ -21,8 +29,76 @@ String ComputeShaderKernel::get_compile_error() const {
 	return {};
 }
 
+void ComputeShaderKernel::compile_bytecode(RenderingDevice* rendering_device) {
+	bytecode = {};
+	bytecode_key = {};
+	ERR_FAIL_NULL(rendering_device);
+	if (spirv.is_null() || !get_compile_error().is_empty())
+		return;
+	bytecode = rendering_device->shader_compile_binary_from_spirv(spirv, kernel_name);
+	if (!bytecode.is_empty()) {
+		bytecode_key = get_device_bytecode_key(rendering_device);
+	}
+}
+
+RID ComputeShaderKernel::create_shader(RenderingDevice* rendering_device, const String& name) const {
+	ERR_FAIL_NULL_V(rendering_device, {});
+	const String device_key = get_device_bytecode_key(rendering_device);
+	if (!bytecode.is_empty() && bytecode_key == device_key) {
+		if (const RID shader_rid = rendering_device->shader_create_from_bytecode(bytecode); shader_rid.is_valid()) {
+			return shader_rid;
+		}
+	}
+
+	// the imported bytecode was compiled for a different device or driver, so fall back to a per-device cache
+	const String cache_path = _get_bytecode_cache_path(device_key);
+	if (FileAccess::file_exists(cache_path)) {
+		const PackedByteArray cached_bytecode = FileAccess::get_file_as_bytes(cache_path);
+		if (const RID shader_rid = rendering_device->shader_create_from_bytecode(cached_bytecode); shader_rid.is_valid()) {
+			return shader_rid;
+		}
+	}
+
+	ERR_FAIL_NULL_V(spirv, {});
+	const PackedByteArray compiled_bytecode = rendering_device->shader_compile_binary_from_spirv(spirv, name);
+	if (compiled_bytecode.is_empty()) {
+		return rendering_device->shader_create_from_spirv(spirv, name);
+	}
+	if (DirAccess::make_dir_recursive_absolute(cache_path.get_base_dir()) == OK) {
+		if (const Ref<FileAccess> cache_file = FileAccess::open(cache_path, FileAccess::WRITE); cache_file.is_valid()) {
+			cache_file->store_buffer(compiled_bytecode);
+		}
+	}
+	return rendering_device->shader_create_from_bytecode(compiled_bytecode);
+}
+
+String ComputeShaderKernel::get_device_bytecode_key(RenderingDevice* rendering_device) {
+	ERR_FAIL_NULL_V(rendering_device, {});
+	const RenderingServer* rendering_server = RenderingServer::get_singleton();
+	const Dictionary version_info = Engine::get_singleton()->get_version_info();
+	return String("%s|%s|%s|%s|%s") % Array{
+		version_info.get("hash", ""),
+		rendering_device->get_device_vendor_name(),
+		rendering_device->get_device_name(),
+		rendering_device->get_device_pipeline_cache_uuid(),
+		rendering_server ? rendering_server->get_video_adapter_api_version() : String(),
+	};
+}
+
+String ComputeShaderKernel::_get_bytecode_cache_path(const String& device_key) const {
+	const PackedByteArray spirv_bytecode = spirv.is_valid() ? spirv->get_stage_bytecode(RenderingDevice::SHADER_STAGE_COMPUTE) : PackedByteArray();
+	const uint32_t spirv_hash = hash_murmur3_buffer(spirv_bytecode.ptr(), static_cast<int>(spirv_bytecode.size()));
+	return String("user://slang_shader_cache/%s/%s_%s.bin") % Array{
+		device_key.md5_text(),
+		String::num_uint64(spirv_hash, 16),
+		String::num_int64(spirv_bytecode.size()),
+	};
+}
+
 GET_SET_PROPERTY_IMPL(ComputeShaderKernel, StringName, kernel_name);
 GET_SET_PROPERTY_IMPL(ComputeShaderKernel, Ref<RDShaderSPIRV>, spirv);
+GET_SET_PROPERTY_IMPL(ComputeShaderKernel, PackedByteArray, bytecode);
+GET_SET_PROPERTY_IMPL(ComputeShaderKernel, String, bytecode_key);
 GET_SET_PROPERTY_IMPL(ComputeShaderKernel, Vector3i, thread_group_size);
 GET_SET_PROPERTY_IMPL(ComputeShaderKernel, int64_t, space_offset);
 GET_SET_PROPERTY_IMPL(ComputeShaderKernel, int64_t, slot_offset);
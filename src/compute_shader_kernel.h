@@ -1,6 +1,7 @@
 #pragma once
 
 #include "godot_cpp/classes/rd_shader_spirv.hpp"
+#include "godot_cpp/classes/rendering_device.hpp"
 #include "godot_cpp/classes/resource.hpp"
 
 #include "binding_macros.h"
@@ -11,6 +12,8 @@ class ComputeShaderKernel : public godot::Resource {
 
 	GET_SET_PROPERTY(godot::StringName, kernel_name)
 	GET_SET_PROPERTY(godot::Ref<godot::RDShaderSPIRV>, spirv)
+	GET_SET_PROPERTY(godot::PackedByteArray, bytecode)
+	GET_SET_PROPERTY(godot::String, bytecode_key)
 	GET_SET_PROPERTY(godot::Vector3i, thread_group_size)
 	GET_SET_PROPERTY(int64_t, space_offset)
 	GET_SET_PROPERTY(int64_t, slot_offset)
@@ -26,4 +29,12 @@ public:
 	~ComputeShaderKernel() override = default;
 
 	godot::String get_compile_error() const;
+
+	void compile_bytecode(godot::RenderingDevice* rendering_device);
+	godot::RID create_shader(godot::RenderingDevice* rendering_device, const godot::String& name) const;
+
+	static godot::String get_device_bytecode_key(godot::RenderingDevice* rendering_device);
+
+private:
+	godot::String _get_bytecode_cache_path(const godot::String& device_key) const;
 };
@@ -1,5 +1,8 @@
 #include "compute_shader_shape.h"
 
+#include <algorithm>
+
+#include "attributes.h"
 #include "compute_shader_cursor.h"
 #include "compute_shader_file.h"
 #include "enums.h"
@@ -37,7 +40,32 @@ void ResourceTypeLayoutShape::_bind_methods() {
     BIND_GET_SET_ENUM(ResourceTypeLayoutShape, uniform_type, ENUM_HINT_STRING(RenderingDevice, UniformType))
 }
 
-GET_SET_PROPERTY_IMPL(ShaderTypeLayoutShape, TypedArray<Dictionary>, bindings)
+ShaderTypeLayoutShape::ShaderTypeLayoutShape() : path_cache(std::make_unique<ComputeShaderPathCache>()) { }
+ShaderTypeLayoutShape::~ShaderTypeLayoutShape() = default;
+
+TypedArray<Dictionary> ShaderTypeLayoutShape::get_bindings() const { return bindings; }
+
+void ShaderTypeLayoutShape::set_bindings(TypedArray<Dictionary> p_bindings) {
+	bindings = p_bindings;
+	path_cache->clear();
+	binding_ranges.clear();
+	binding_ranges.reserve(bindings.size());
+	for (const Dictionary binding : bindings) {
+		binding_ranges.push_back(BindingRange::from_dict(binding));
+	}
+}
+
+std::optional<FieldShape> ShaderTypeLayoutShape::field(const StringName& field_name) const {
+	if (const FieldShape* field_shape = find_field(field_name)) {
+		return *field_shape;
+	}
+	return std::nullopt;
+}
+
+const BindingRange* ShaderTypeLayoutShape::get_binding_range(const int64_t binding_range_index) const {
+	ERR_FAIL_INDEX_V(binding_range_index, static_cast<int64_t>(binding_ranges.size()), nullptr);
+	return &binding_ranges[binding_range_index];
+}
 
 GET_SET_PROPERTY_IMPL(VariantTypeLayoutShape, ShaderTypeLayoutShape::MatrixLayout, matrix_layout)
 
@@ -46,7 +74,27 @@ GET_SET_PROPERTY_IMPL(ArrayTypeLayoutShape, int64_t, stride)
 GET_SET_PROPERTY_IMPL(ArrayTypeLayoutShape, int64_t, element_count)
 
 GET_SET_PROPERTY_IMPL(StructTypeLayoutShape, int64_t, alignment)
-GET_SET_PROPERTY_IMPL(StructTypeLayoutShape, Dictionary, properties)
+Dictionary StructTypeLayoutShape::get_properties() const { return properties; }
+
+void StructTypeLayoutShape::set_properties(Dictionary p_properties) {
+	{
+		// taken separately, as building the encoder takes field_write_handlers_mutex
+		std::lock_guard encoder_lock(encoder_mutex);
+		encoder = nullptr;
+		has_encoder = false;
+	}
+	std::lock_guard lock(field_write_handlers_mutex);
+	properties = p_properties;
+	get_path_cache().clear();
+	fields.clear();
+	field_indices.clear();
+	field_write_handlers.clear();
+	fields.reserve(properties.size());
+	for (const StringName field_name : properties.keys()) {
+		field_indices.insert(field_name, fields.size());
+		fields.push_back(FieldShape::from_dict(properties[field_name]));
+	}
+}
 GET_SET_PROPERTY_IMPL(StructTypeLayoutShape, Dictionary, user_attributes)
 
 GET_SET_PROPERTY_IMPL(ResourceTypeLayoutShape, ResourceTypeLayoutShape::ComputeShaderResourceType, resource_type)
@@ -73,6 +121,12 @@ int64_t ArrayTypeLayoutShape::get_size() const { return size; }
 void ArrayTypeLayoutShape::set_size(const int64_t p_size) { size = p_size; }
 
 void ArrayTypeLayoutShape::write_into(const ComputeShaderCursor& cursor, const Variant& data) const {
+	if (!get_element_count()) {
+		// the written elements replace the contents of an unbounded buffer, which grows back to their size as they are written
+		cursor.set_buffer_size(0);
+	}
+	if (_try_write_packed(cursor, data) || _try_write_columns(cursor, data) || _try_write_structs(cursor, data))
+		return;
 	// TODO: Maybe these should be separate shapes
 	if (get_element_count()) {
 		// fixed-size array
@@ -101,6 +155,213 @@ void ArrayTypeLayoutShape::write_into(const ComputeShaderCursor& cursor, const V
 	}
 }
 
+namespace {
+	// a packed array viewed as raw bytes
+	struct PackedArrayBytes {
+		// keeps the array (and with it the bytes) alive
+		Variant array;
+		std::span<const uint8_t> bytes;
+		int64_t stride;
+	};
+
+	template<typename TArray>
+	PackedArrayBytes make_packed_array_bytes(const Variant& data) {
+		const TArray array = data;
+		return { data, { reinterpret_cast<const uint8_t*>(array.ptr()), static_cast<size_t>(array.size()) * sizeof(*array.ptr()) }, sizeof(*array.ptr()) };
+	}
+
+	// only arrays whose elements serialize to their in-memory representation can be copied directly
+	std::optional<PackedArrayBytes> get_packed_array_bytes(const Variant& data) {
+		switch (data.get_type()) {
+			case Variant::PACKED_INT32_ARRAY:
+				return make_packed_array_bytes<PackedInt32Array>(data);
+			case Variant::PACKED_FLOAT32_ARRAY:
+				return make_packed_array_bytes<PackedFloat32Array>(data);
+#ifndef REAL_T_IS_DOUBLE
+			// vectors hold doubles in double precision builds, which have to be converted element by element
+			case Variant::PACKED_VECTOR2_ARRAY:
+				return make_packed_array_bytes<PackedVector2Array>(data);
+			case Variant::PACKED_VECTOR3_ARRAY:
+				return make_packed_array_bytes<PackedVector3Array>(data);
+			case Variant::PACKED_VECTOR4_ARRAY:
+				return make_packed_array_bytes<PackedVector4Array>(data);
+#endif
+			case Variant::PACKED_COLOR_ARRAY:
+				return make_packed_array_bytes<PackedColorArray>(data);
+			default:
+				return std::nullopt;
+		}
+	}
+
+	int64_t get_iterable_size(const Variant& data) {
+		int64_t size = 0;
+		Variant key;
+		bool is_valid{};
+		if (data.iter_init(key, is_valid) && is_valid) {
+			do {
+				++size;
+			} while (data.iter_next(key, is_valid) && is_valid);
+		}
+		return size;
+	}
+}
+
+bool ArrayTypeLayoutShape::_try_write_packed(const ComputeShaderCursor& cursor, const Variant& data) const {
+	// handlers may rewrite each element, so those have to go through the per-element path
+	if (cursor.has_write_handlers())
+		return false;
+	const auto element_shape = Object::cast_to<VariantTypeLayoutShape>(get_element_shape().ptr());
+	if (!element_shape || element_shape->get_size() <= 0 || get_stride() <= 0)
+		return false;
+	const std::optional<PackedArrayBytes> packed = get_packed_array_bytes(data);
+	if (!packed)
+		return false;
+	_write_packed(cursor, packed->bytes, packed->stride, element_shape->get_size());
+	return true;
+}
+
+bool ArrayTypeLayoutShape::_try_write_columns(const ComputeShaderCursor& cursor, const Variant& data) const {
+	if (data.get_type() != Variant::DICTIONARY || cursor.has_write_handlers())
+		return false;
+	const auto struct_shape = Object::cast_to<StructTypeLayoutShape>(get_element_shape().ptr());
+	if (!struct_shape || get_stride() <= 0)
+		return false;
+
+	// a dictionary of columns, one array of values per struct field
+	const Dictionary columns = data;
+	for (const Variant& column_name : columns.keys()) {
+		ERR_CONTINUE_MSG(!struct_shape->find_field(column_name), String("No such field '%s'!") % column_name);
+	}
+
+	struct PackedColumn {
+		const FieldShape* field;
+		PackedArrayBytes packed;
+	};
+	std::vector<PackedColumn> packed_columns{};
+	// written element by element after the packed columns, e.g. fields with write handlers or Array columns
+	std::vector<std::pair<const FieldShape*, Variant>> generic_columns{};
+	int64_t source_count = 0;
+	for (const FieldShape& field : struct_shape->get_fields()) {
+		const Variant column = columns.get(field.name, Variant());
+		const auto field_shape = Object::cast_to<VariantTypeLayoutShape>(field.shape.ptr());
+		const std::shared_ptr<const FieldWriteHandlers> handlers = struct_shape->get_field_write_handlers(field);
+		const bool is_plain = field_shape && field_shape->get_size() > 0 && (!handlers || handlers->empty());
+		if (std::optional<PackedArrayBytes> packed = is_plain ? get_packed_array_bytes(column) : std::nullopt) {
+			source_count = Math::max<int64_t>(source_count, packed->bytes.size() / packed->stride);
+			packed_columns.push_back(PackedColumn{ &field, std::move(*packed) });
+		} else if (column.get_type() != Variant::NIL) {
+			source_count = Math::max(source_count, get_iterable_size(column));
+			generic_columns.emplace_back(&field, column);
+		} else if (!is_plain) {
+			// missing plain fields are zeroed, anything else still gets a chance to run its handlers
+			generic_columns.emplace_back(&field, column);
+		}
+	}
+
+	// fixed-size arrays are always written in full, missing elements are zeroed
+	const int64_t count = get_element_count() ? get_element_count() : source_count;
+	if (count == 0) {
+		// ensures a buffer is at least created with the default sizing
+		cursor.write_bytes(std::span<const uint8_t>());
+		return true;
+	}
+
+	// interleave every packed column into a staging copy of the whole array, then write it at once
+	const int64_t stride = get_stride();
+	PackedByteArray staging;
+	staging.resize((count - 1) * stride + Math::min(stride, struct_shape->get_size()));
+	staging.fill(0);
+	uint8_t* destination = staging.ptrw();
+	for (const auto& [field, packed] : packed_columns) {
+		const int64_t field_size = Object::cast_to<VariantTypeLayoutShape>(field->shape.ptr())->get_size();
+		const int64_t copy_size = Math::min(packed.stride, field_size);
+		const int64_t copy_count = Math::min<int64_t>(count, packed.bytes.size() / packed.stride);
+		ERR_CONTINUE(field->byte_offset + copy_size > struct_shape->get_size());
+		uint8_t* field_destination = destination + field->byte_offset;
+		const uint8_t* source = packed.bytes.data();
+		for (int64_t i = 0; i < copy_count; ++i) {
+			memcpy(field_destination + i * stride, source + i * packed.stride, copy_size);
+		}
+	}
+	cursor.write_bytes(std::span<const uint8_t>(staging.ptr(), staging.size()));
+
+	for (const auto& [field, column] : generic_columns) {
+		for (int64_t i = 0; i < count; ++i) {
+			bool is_valid{}, oob{};
+			cursor.element(i).field(field->name).write(column.get_indexed(i, is_valid, oob));
+		}
+	}
+	return true;
+}
+
+bool ArrayTypeLayoutShape::_try_write_structs(const ComputeShaderCursor& cursor, const Variant& data) const {
+	// fixed-size arrays may live in constant buffers, which use a different layout
+	if (data.get_type() != Variant::ARRAY || get_element_count() || cursor.has_write_handlers())
+		return false;
+	const auto struct_shape = Object::cast_to<StructTypeLayoutShape>(get_element_shape().ptr());
+	if (!struct_shape || get_stride() <= 0)
+		return false;
+	const std::shared_ptr<const StructEncoder> encoder = struct_shape->get_encoder();
+	if (!encoder)
+		return false;
+
+	const Array elements = data;
+	const int64_t count = elements.size();
+	if (count == 0) {
+		// ensures a buffer is at least created with the default sizing
+		cursor.write_bytes(std::span<const uint8_t>());
+		return true;
+	}
+
+	const int64_t stride = get_stride();
+	const int64_t element_size = Math::min(stride, struct_shape->get_size());
+	PackedByteArray staging;
+	staging.resize((count - 1) * stride + element_size);
+	staging.fill(0);
+	uint8_t* destination = staging.ptrw();
+	std::vector<int64_t> generic_elements{};
+	for (int64_t i = 0; i < count; ++i) {
+		if (!encoder->encode(elements[i], std::span(destination + i * stride, element_size))) {
+			generic_elements.push_back(i);
+		}
+	}
+	cursor.write_bytes(std::span<const uint8_t>(staging.ptr(), staging.size()));
+
+	for (const int64_t i : generic_elements) {
+		cursor.element(i).write(elements[i]);
+	}
+	return true;
+}
+
+void ArrayTypeLayoutShape::_write_packed(const ComputeShaderCursor& cursor, const std::span<const uint8_t> bytes, const int64_t source_stride, const int64_t element_size) const {
+	const int64_t source_count = bytes.size() / source_stride;
+	// fixed-size arrays are always written in full, missing elements are zeroed
+	const int64_t count = get_element_count() ? get_element_count() : source_count;
+	if (count == 0) {
+		// ensures a buffer is at least created with the default sizing
+		cursor.write_bytes(std::span<const uint8_t>());
+		return;
+	}
+	const int64_t stride = get_stride();
+	if (stride == source_stride && count == source_count) {
+		// the source is laid out exactly like the destination
+		cursor.write_bytes(bytes);
+		return;
+	}
+
+	// strided scatter into a staging copy, so the buffer still sees a single write
+	PackedByteArray staging;
+	staging.resize((count - 1) * stride + element_size);
+	staging.fill(0);
+	uint8_t* destination = staging.ptrw();
+	const int64_t copy_size = Math::min(source_stride, element_size);
+	const int64_t copy_count = Math::min(count, source_count);
+	for (int64_t i = 0; i < copy_count; ++i) {
+		memcpy(destination + i * stride, bytes.data() + i * source_stride, copy_size);
+	}
+	cursor.write_bytes(std::span<const uint8_t>(staging.ptr(), staging.size()));
+}
+
 #define STR_NAME_KEY(name) const StringName& key_##name() { \
 static StringName key(#name); \
 return key; \
@@ -121,6 +382,7 @@ STR_NAME_KEY(binding_count)
 STR_NAME_KEY(size)
 STR_NAME_KEY(alignment)
 STR_NAME_KEY(leaf_shape)
+STR_NAME_KEY(data_format)
 
 #undef STR_NAME_KEY
 
@@ -171,6 +433,9 @@ BindingRange::operator Dictionary() const {
 	if (leaf_shape.is_valid()) {
 		result[key_leaf_shape()] = leaf_shape;
 	}
+	if (data_format) {
+		result[key_data_format()] = *data_format;
+	}
 	return result;
 }
 
@@ -183,6 +448,9 @@ BindingRange BindingRange::from_dict(const Dictionary& dict) {
 		dict.get(key_size(), 0),
 		dict.get(key_alignment(), 1),
 		dict.get(key_leaf_shape(), {}),
+		dict.has(key_data_format())
+			? std::make_optional(static_cast<RenderingDevice::DataFormat>(static_cast<int64_t>(dict[key_data_format()])))
+			: std::nullopt,
 	};
 }
 
@@ -190,19 +458,112 @@ int64_t StructTypeLayoutShape::get_size() const { return size; }
 
 void StructTypeLayoutShape::set_size(const int64_t p_size) { size = p_size; }
 
-std::optional<FieldShape> StructTypeLayoutShape::field(const StringName& field_name) const {
-	if (properties.has(field_name)) {
-		return FieldShape::from_dict(properties[field_name]);
+const FieldShape* StructTypeLayoutShape::find_field(const StringName& field_name) const {
+	if (const auto field_index = field_indices.find(field_name); field_index != field_indices.end()) {
+		return &fields[field_index->value];
 	}
-	return std::nullopt;
+	return nullptr;
+}
+
+std::shared_ptr<const FieldWriteHandlers> StructTypeLayoutShape::get_field_write_handlers(const FieldShape& field) const {
+	const int64_t field_index = &field - fields.data();
+	ERR_FAIL_INDEX_V(field_index, static_cast<int64_t>(fields.size()), nullptr);
+	std::lock_guard lock(field_write_handlers_mutex);
+	if (const uint64_t version = AttributeRegistry::get_instance()->get_write_handlers_version(); version != field_write_handlers_version) {
+		field_write_handlers.clear();
+		field_write_handlers_version = version;
+	}
+	if (field_write_handlers.empty()) {
+		field_write_handlers.resize(fields.size());
+	}
+	std::shared_ptr<const FieldWriteHandlers>& cached_handlers = field_write_handlers[field_index];
+	if (cached_handlers) {
+		return cached_handlers;
+	}
+
+	std::vector<std::pair<AttributeRegistry::WriteHandler, int64_t>> handlers_with_priority{};
+	const Dictionary attributes = field.user_attributes;
+	for (const StringName attribute_name : attributes.keys()) {
+		const Dictionary attribute_arguments = attributes[attribute_name];
+		if (const auto factory = AttributeRegistry::get_instance()->get_write_handler(attribute_name)) {
+			if (auto handler = factory->factory(attribute_arguments, field)) {
+				handlers_with_priority.emplace_back(std::move(handler), factory->priority);
+			}
+		}
+	}
+	std::stable_sort(handlers_with_priority.begin(), handlers_with_priority.end(), [](const auto& a, const auto& b) {
+		return a.second > b.second;
+	});
+	auto handlers = std::make_shared<FieldWriteHandlers>();
+	handlers->reserve(handlers_with_priority.size());
+	for (auto& [handler, _] : handlers_with_priority) {
+		handlers->push_back(std::move(handler));
+	}
+	cached_handlers = std::move(handlers);
+	return cached_handlers;
+}
+
+std::shared_ptr<const StructEncoder> StructTypeLayoutShape::get_encoder() const {
+	std::lock_guard lock(encoder_mutex);
+	if (const uint64_t version = AttributeRegistry::get_instance()->get_write_handlers_version(); !has_encoder || version != encoder_version) {
+		encoder = _build_encoder();
+		has_encoder = true;
+		encoder_version = version;
+	}
+	return encoder;
+}
+
+std::shared_ptr<const StructEncoder> StructTypeLayoutShape::_build_encoder() const {
+	auto result = std::make_shared<StructEncoder>();
+	result->fields.reserve(fields.size());
+	for (const FieldShape& field : fields) {
+		if (const std::shared_ptr<const FieldWriteHandlers> handlers = get_field_write_handlers(field); handlers && !handlers->empty())
+			return nullptr;
+		if (const auto variant_shape = Object::cast_to<VariantTypeLayoutShape>(field.shape.ptr()); variant_shape && variant_shape->get_size() > 0) {
+			result->fields.push_back(StructEncoder::Field{ field.name, field.byte_offset, variant_shape->get_size(), variant_shape->get_matrix_layout(), nullptr });
+		} else if (const auto struct_shape = Object::cast_to<StructTypeLayoutShape>(field.shape.ptr())) {
+			std::shared_ptr<const StructEncoder> nested = struct_shape->get_encoder();
+			if (!nested)
+				return nullptr;
+			result->fields.push_back(StructEncoder::Field{ field.name, field.byte_offset, struct_shape->get_size(), MatrixLayout::UNKNOWN, std::move(nested) });
+		} else {
+			return nullptr;
+		}
+		ERR_FAIL_COND_V(result->fields.back().byte_offset + result->fields.back().size > get_size(), nullptr);
+	}
+	return result;
+}
+
+bool StructEncoder::encode(const Variant& value, const std::span<uint8_t> destination) const {
+	const Variant::Type type = value.get_type();
+	if (type == Variant::NIL)
+		return true;
+	const Object* object = type == Variant::OBJECT ? static_cast<Object*>(value) : nullptr;
+	if (type != Variant::DICTIONARY && !object)
+		return false;
+	if (Object::cast_to<RDUniform>(object))
+		return false;
+
+	const Dictionary dictionary = type == Variant::DICTIONARY ? static_cast<Dictionary>(value) : Dictionary();
+	for (const Field& field : fields) {
+		if (field.byte_offset + field.size > static_cast<int64_t>(destination.size()))
+			continue;
+		const Variant field_value = object ? object->get(field.name) : dictionary.get(field.name, Variant());
+		const std::span<uint8_t> field_destination = destination.subspan(field.byte_offset, field.size);
+		if (field.nested) {
+			ERR_CONTINUE_MSG(!field.nested->encode(field_value, field_destination), String("Unsupported value for struct field '%s'!") % field.name);
+		} else if (field_value.get_type() != Variant::NIL) {
+			const VariantSerializer::Buffer serialized = VariantSerializer::serialize(field_value, BufferLayout::STD430, field.matrix_layout);
+			serialized.copy(field_destination.data(), field_destination.size());
+		}
+	}
+	return true;
 }
 
 void StructTypeLayoutShape::write_into(const ComputeShaderCursor& cursor, const Variant& data) const {
-    const Dictionary fields = get_properties();
-    for (const StringName field_name : fields.keys()) {
-        const FieldShape field = FieldShape::from_dict(fields[field_name]);
+    for (const FieldShape& field : fields) {
         bool is_valid{};
 		const Variant field_value = data.get_named(field.name, is_valid);
-        cursor.field(field_name).write(field_value);
+        cursor.field(field.name).write(field_value);
     }
 }
@@ -1,16 +1,26 @@
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
+#include <vector>
 
 #include "godot_cpp/classes/resource.hpp"
+#include "godot_cpp/templates/hash_map.hpp"
 
 #include "binding_macros.h"
 #include "godot_cpp/classes/rendering_device.hpp"
 
 class ShaderTypeLayoutShape;
 class ComputeShaderCursor;
+class ComputeShaderPathCache;
 struct BindingRange;
 
+// attribute write handlers of a single field, highest priority first
+using FieldWriteHandlers = std::vector<std::function<void(godot::Variant& value, const godot::Object* context)>>;
+
 struct FieldShape {
 
 	godot::StringName name{};
@@ -35,8 +45,19 @@ protected:
 	static void _bind_methods();
 
 public:
+	// defined out of line, as BindingRange and ComputeShaderPathCache are incomplete here
+	ShaderTypeLayoutShape();
+	~ShaderTypeLayoutShape() override;
+
 	[[nodiscard]] virtual int64_t get_size() const { return 0; }
-	virtual std::optional<FieldShape> field(const godot::StringName& field_name) const { return std::nullopt; }
+	[[nodiscard]] virtual const FieldShape* find_field(const godot::StringName& field_name) const { return nullptr; }
+	[[nodiscard]] std::optional<FieldShape> field(const godot::StringName& field_name) const;
+	[[nodiscard]] virtual std::shared_ptr<const FieldWriteHandlers> get_field_write_handlers(const FieldShape& field) const { return nullptr; }
+	// runtime form of bindings, decoded once when they are set
+	[[nodiscard]] const std::vector<BindingRange>& get_binding_ranges() const { return binding_ranges; }
+	[[nodiscard]] const BindingRange* get_binding_range(int64_t binding_range_index) const;
+	// cursor paths resolved from the root of an object with this shape
+	[[nodiscard]] ComputeShaderPathCache& get_path_cache() const { return *path_cache; }
 	virtual void write_into(const ComputeShaderCursor& cursor, const godot::Variant& data) const = 0;
 
 	// Values must match SlangMatrixLayoutMode
@@ -80,6 +101,10 @@ public:
 	static godot::String get_matrix_layout_hint_string() {
 		return godot::String("Unknown:%s,Row-major:%s,Column-major:%s") % godot::Array { godot::String::num_int64(UNKNOWN), godot::String::num_int64(ROW_MAJOR), godot::String::num_int64(COLUMN_MAJOR) };
 	}
+
+private:
+	std::vector<BindingRange> binding_ranges{};
+	std::unique_ptr<ComputeShaderPathCache> path_cache;
 };
 
 class VariantTypeLayoutShape : public ShaderTypeLayoutShape {
@@ -118,6 +143,32 @@ public:
 private:
 	int64_t size{};
 
+	// writes a packed array of plain values in one go instead of element by element
+	bool _try_write_packed(const ComputeShaderCursor& cursor, const godot::Variant& data) const;
+	void _write_packed(const ComputeShaderCursor& cursor, std::span<const uint8_t> bytes, int64_t source_stride, int64_t element_size) const;
+	// writes a dictionary of per-field columns into an array of structs, interleaving packed columns in one pass
+	bool _try_write_columns(const ComputeShaderCursor& cursor, const godot::Variant& data) const;
+	// encodes an Array of Dictionaries or Objects into a structured buffer with a single write
+	bool _try_write_structs(const ComputeShaderCursor& cursor, const godot::Variant& data) const;
+
+};
+
+// flattened layout of a struct whose fields are all plain data, used to encode many elements at once
+struct StructEncoder {
+	struct Field {
+		godot::StringName name{};
+		int64_t byte_offset{};
+		int64_t size{};
+		ShaderTypeLayoutShape::MatrixLayout matrix_layout{};
+		// set for nested structs, whose fields are relative to byte_offset
+		std::shared_ptr<const StructEncoder> nested{};
+	};
+
+	std::vector<Field> fields{};
+
+	// encodes a Dictionary or Object into destination, which is expected to be zeroed
+	// returns false for any other kind of value
+	bool encode(const godot::Variant& value, std::span<uint8_t> destination) const;
 };
 
 class StructTypeLayoutShape : public ShaderTypeLayoutShape {
@@ -133,11 +184,29 @@ protected:
 public:
 	[[nodiscard]] int64_t get_size() const override;
 	void set_size(int64_t p_size);
-	std::optional<FieldShape> field(const godot::StringName& field_name) const override;
+	// runtime form of properties, decoded once when they are set, in declaration order
+	[[nodiscard]] const std::vector<FieldShape>& get_fields() const { return fields; }
+	[[nodiscard]] const FieldShape* find_field(const godot::StringName& field_name) const override;
+	// instantiated from the attribute registry on first use, then shared by every cursor into the field
+	[[nodiscard]] std::shared_ptr<const FieldWriteHandlers> get_field_write_handlers(const FieldShape& field) const override;
+	// built on first use, null if any field isn't plain data or has write handlers
+	[[nodiscard]] std::shared_ptr<const StructEncoder> get_encoder() const;
 	void write_into(const ComputeShaderCursor& cursor, const godot::Variant& data) const override;
 
 private:
 	int64_t size{};
+	std::vector<FieldShape> fields{};
+	godot::HashMap<godot::StringName, uint32_t> field_indices{};
+	mutable std::vector<std::shared_ptr<const FieldWriteHandlers>> field_write_handlers{};
+	mutable std::mutex field_write_handlers_mutex{};
+	// registry version the cached handlers and encoder were built against
+	mutable uint64_t field_write_handlers_version{};
+	mutable std::shared_ptr<const StructEncoder> encoder{};
+	mutable bool has_encoder{};
+	mutable uint64_t encoder_version{};
+	mutable std::mutex encoder_mutex{};
+
+	[[nodiscard]] std::shared_ptr<const StructEncoder> _build_encoder() const;
 
 };
 
@@ -173,6 +242,8 @@ struct BindingRange {
 	int64_t size{};
 	int64_t alignment{};
 	godot::Ref<ShaderTypeLayoutShape> leaf_shape{};
+	// texel format of a typed buffer, from its reflected element type
+	std::optional<godot::RenderingDevice::DataFormat> data_format{};
 
 	ShaderTypeLayoutShape::BindingType base_binding_type() const {
 		return ShaderTypeLayoutShape::base_binding_type(type);
@@ -1,15 +1,19 @@
+#include <algorithm>
+#include <numeric>
+#include <unordered_set>
+
 #include "godot_cpp/classes/editor_file_system.hpp"
 #include "godot_cpp/classes/editor_interface.hpp"
 #include "godot_cpp/classes/engine.hpp"
 #include "godot_cpp/classes/rd_uniform.hpp"
 #include "godot_cpp/classes/rendering_server.hpp"
-#include "godot_cpp/classes/uniform_set_cache_rd.hpp"
 #include "godot_cpp/classes/window.hpp"
 
 #include "attributes.h"
 #include "compute_shader_cursor.h"
 #include "compute_shader_shape.h"
 #include "sampler_cache.h"
+#include "variant_utils.h"
 
 #include "compute_shader_task.h"
 
@@ -35,26 +39,48 @@ const StringName& kernel_param_prefix() {
 void ComputeShaderTask::_bind_methods() {
 	BIND_GET_SET_RESOURCE(ComputeShaderTask, shader, ComputeShaderFile)
 	BIND_GET_SET_OBJECT(ComputeShaderTask, rendering_device, RenderingDevice)
+	BIND_GET_SET(ComputeShaderTask, upload_budget, Variant::INT, PROPERTY_HINT_RANGE, "0,1073741824,1,or_greater,suffix:B")
 	BIND_METHOD(ComputeShaderTask, get_shader_parameter, "param")
 	BIND_METHOD(ComputeShaderTask, set_shader_parameter, "param", "value")
 	BIND_METHOD(ComputeShaderTask, get_kernel_parameter, "kernel", "param")
 	BIND_METHOD(ComputeShaderTask, set_kernel_parameter, "kernel", "param", "value")
 	BIND_METHOD(ComputeShaderTask, clear_shader_parameters)
+	BIND_METHOD(ComputeShaderTask, get_parameter_handle, "param")
+	BIND_METHOD(ComputeShaderTask, set_parameter_by_handle, "handle", "value")
 	ClassDB::bind_method(D_METHOD("dispatch", "kernel_name", "thread_groups", "context"), &ComputeShaderTask::dispatch, DEFVAL(nullptr));
 	ClassDB::bind_method(D_METHOD("dispatch_at", "kernel_index", "thread_groups", "context"), &ComputeShaderTask::dispatch_at, DEFVAL(nullptr));
 	ClassDB::bind_method(D_METHOD("dispatch_all", "thread_groups", "context"), &ComputeShaderTask::dispatch_all, DEFVAL(nullptr));
 	ClassDB::bind_method(D_METHOD("dispatch_group", "group_name", "thread_groups", "context"), &ComputeShaderTask::dispatch_group, DEFVAL(nullptr));
+	ClassDB::bind_method(D_METHOD("dispatch_group_by_id", "group_id", "thread_groups", "context"), &ComputeShaderTask::dispatch_group_by_id, DEFVAL(nullptr));
+	BIND_METHOD(ComputeShaderTask, get_kernel_group_id, "group_name")
+	BIND_METHOD(ComputeShaderTask, get_pending_upload_bytes)
+	ClassDB::bind_method(D_METHOD("warmup", "kernels"), &ComputeShaderTask::warmup, DEFVAL(TypedArray<StringName>()));
+	ClassDB::bind_method(D_METHOD("dispatch_indirect", "kernel_name", "args_param", "byte_offset", "context"), &ComputeShaderTask::dispatch_indirect, DEFVAL(0), DEFVAL(nullptr));
 	BIND_METHOD(ComputeShaderTask, get_rids, "param")
 	BIND_METHOD(ComputeShaderTask, get_buffer_data, "param")
 	BIND_METHOD(ComputeShaderTask, get_buffer_data_async, "param", "callback")
 	BIND_METHOD(ComputeShaderTask, get_kernel_rids, "kernel", "param")
 	BIND_METHOD(ComputeShaderTask, get_kernel_buffer_data, "kernel", "param")
 	BIND_METHOD(ComputeShaderTask, get_kernel_buffer_data_async, "kernel", "param", "callback")
+	ADD_SIGNAL(MethodInfo("warmup_completed"));
+	ADD_SIGNAL(MethodInfo("upload_progressed", PropertyInfo(Variant::INT, "uploaded_bytes"), PropertyInfo(Variant::INT, "total_bytes")));
+	ADD_SIGNAL(MethodInfo("upload_completed"));
 }
 
 ComputeShaderTask::ComputeShaderTask() :
-		_shader_object(nullptr) {
+		_shader_object(nullptr), _write_plan(nullptr) {
 	_mutex.instantiate();
+	_parameters_mutex.instantiate();
+}
+
+ComputeShaderTask::~ComputeShaderTask() {
+	if (RenderingServer* rendering_server = RenderingServer::get_singleton()) {
+		for (const Callable& callable : { callable_mp(this, &ComputeShaderTask::_warmup_step), callable_mp(this, &ComputeShaderTask::_upload_step) }) {
+			if (rendering_server->is_connected("frame_pre_draw", callable)) {
+				rendering_server->disconnect("frame_pre_draw", callable);
+			}
+		}
+	}
 }
 
 TypedArray<ComputeShaderKernel> ComputeShaderTask::get_kernels() const {
@@ -74,6 +100,7 @@ void ComputeShaderTask::set_shader(Ref<ComputeShaderFile> p_shader) {
 			shader->disconnect("changed", changed_callable);
 		}
 		shader = p_shader;
+		_rebuild_kernel_tables();
 		if (p_shader.is_valid()) {
 			p_shader->connect("changed", changed_callable);
 			if (p_shader->has_meta("godot_version")) {
@@ -85,6 +112,9 @@ void ComputeShaderTask::set_shader(Ref<ComputeShaderFile> p_shader) {
 		}
 		RenderingServer::get_singleton()->call_on_render_thread(changed_callable);
 		emit_changed();
+		if (p_shader.is_valid() && p_shader->get_autowarm()) {
+			warmup();
+		}
 	}
 }
 
@@ -93,7 +123,6 @@ RenderingDevice* ComputeShaderTask::get_rendering_device() const {
 }
 
 void ComputeShaderTask::set_rendering_device(RenderingDevice* p_rendering_device) {
-	ERR_FAIL_COND_MSG(p_rendering_device, "Overriding the rendering_device is not yet supported!");
 	std::lock_guard lock(*_mutex.ptr());
 	if (p_rendering_device != ObjectDB::get_instance(rendering_device_id)) {
 		rendering_device_id = p_rendering_device ? p_rendering_device->get_instance_id() : ObjectID{};
@@ -101,96 +130,97 @@ void ComputeShaderTask::set_rendering_device(RenderingDevice* p_rendering_device
 	}
 }
 
+int64_t ComputeShaderTask::get_upload_budget() const { return upload_budget; }
+
+void ComputeShaderTask::set_upload_budget(const int64_t p_upload_budget) {
+	std::lock_guard lock(*_mutex.ptr());
+	upload_budget = Math::max<int64_t>(p_upload_budget, 0);
+}
+
 Variant ComputeShaderTask::get_shader_parameter(const StringName& param) const {
-	const PackedStringArray parts = param.split("/");
-	Variant current = _shader_parameters;
-	int64_t i = 0;
-	bool valid;
-	for (; i < parts.size() - 1; ++i) {
-		current = current.get_named(parts[i], valid);
-		if (!valid || current.get_type() == Variant::NIL)
-			return {};
-	}
-	return current.get_named(parts[i], valid);
+	std::lock_guard lock(*_parameters_mutex.ptr());
+	return _get_parameter(_shader_parameters, param);
 }
 
 void ComputeShaderTask::set_shader_parameter(const StringName& param, const Variant& value) {
-	std::lock_guard lock(*_mutex.ptr());
-	const PackedStringArray parts = param.split("/");
-	Variant current = _shader_parameters;
-	int64_t i = 0;
-	bool valid;
-	for (; i < parts.size() - 1; ++i) {
-		Variant next = current.get_named(parts[i], valid);
-		if (!valid || next.get_type() == Variant::NIL) {
-			next = Dictionary();
-			current.set_named(parts[i], next, valid);
-		}
-		current = next;
-	}
-	current.set_named(parts[i], value, valid);
+	const Variant snapshot = _snapshot_parameter(value);
+	std::lock_guard lock(*_parameters_mutex.ptr());
+	_set_parameter(_shader_parameters, param, value);
+	_queue_change(ParameterChange{ {}, param, snapshot });
 }
 
 void ComputeShaderTask::clear_shader_parameters() {
-	std::lock_guard lock(*_mutex.ptr());
+	std::lock_guard lock(*_parameters_mutex.ptr());
 	_shader_parameters.clear();
 	_kernel_parameters.clear();
+	// earlier changes would be cleared anyway
+	_pending_changes.clear();
+	_pending_change_indices.clear();
+	_superseded_changes = 0;
+	_pending_changes.push_back(ParameterChange{ {}, {}, {}, true });
+}
+
+int64_t ComputeShaderTask::get_parameter_handle(const StringName& param) {
+	std::lock_guard lock(*_parameters_mutex.ptr());
+	if (const auto handle = _parameter_handle_ids.find(param); handle != _parameter_handle_ids.end()) {
+		return handle->value;
+	}
+	ERR_FAIL_NULL_V(shader, -1);
+	const std::vector<StringName> parts = split_path(param);
+	Ref<ShaderTypeLayoutShape> shape = shader->get_parameters();
+	for (const StringName& part : parts) {
+		ERR_FAIL_NULL_V_MSG(shape, -1, String("No such parameter '%s'!") % param);
+		const FieldShape* field = shape->find_field(part);
+		ERR_FAIL_NULL_V_MSG(field, -1, String("No such parameter '%s'!") % param);
+		shape = field->shape;
+	}
+	const int64_t handle = _parameter_handles.size();
+	_parameter_handles.push_back(ParameterHandle{ param, parts });
+	_parameter_handle_ids.insert(param, handle);
+	return handle;
+}
+
+void ComputeShaderTask::set_parameter_by_handle(const int64_t handle, const Variant& value) {
+	const Variant snapshot = _snapshot_parameter(value);
+	std::lock_guard lock(*_parameters_mutex.ptr());
+	ERR_FAIL_INDEX_MSG(handle, static_cast<int64_t>(_parameter_handles.size()), String("Invalid parameter handle %s!") % String::num_int64(handle));
+	const ParameterHandle& parameter_handle = _parameter_handles[handle];
+	_set_parameter(_shader_parameters, parameter_handle.param_parts, value);
+	_queue_change(ParameterChange{ {}, parameter_handle.param, snapshot, false, handle, parameter_handle.param_parts });
 }
 
 Variant ComputeShaderTask::get_kernel_parameter(const StringName& kernel, const StringName& param) const {
-	const PackedStringArray parts = param.split("/");
+	std::lock_guard lock(*_parameters_mutex.ptr());
 	const Dictionary* params_ptr = _kernel_parameters.getptr(kernel);
 	if (!params_ptr)
 		return {};
-	Variant current = *params_ptr;
-	int64_t i = 0;
-	bool valid;
-	for (; i < parts.size() - 1; ++i) {
-		current = current.get_named(parts[i], valid);
-		if (!valid || current.get_type() == Variant::NIL)
-			return {};
-	}
-	return current.get_named(parts[i], valid);
+	return _get_parameter(*params_ptr, param);
 }
 
 void ComputeShaderTask::set_kernel_parameter(const StringName& kernel, const StringName& param, const Variant& value) {
-	std::lock_guard lock(*_mutex.ptr());
-	const PackedStringArray parts = param.split("/");
+	const Variant snapshot = _snapshot_parameter(value);
+	std::lock_guard lock(*_parameters_mutex.ptr());
 	if (!_kernel_parameters.has(kernel)) {
 		_kernel_parameters[kernel] = Dictionary();
 	}
-	Variant current = _kernel_parameters[kernel];
-	int64_t i = 0;
-	bool valid;
-	for (; i < parts.size() - 1; ++i) {
-		Variant next = current.get_named(parts[i], valid);
-		if (!valid || next.get_type() == Variant::NIL) {
-			next = Dictionary();
-			current.set_named(parts[i], next, valid);
-		}
-		current = next;
-	}
-	current.set_named(parts[i], value, valid);
+	_set_parameter(_kernel_parameters[kernel], param, value);
+	_queue_change(ParameterChange{ kernel, param, snapshot });
 }
 
 void ComputeShaderTask::dispatch_all(const Vector3i thread_groups, const Object* context) {
 	std::lock_guard lock(*_mutex.ptr());
 	ERR_FAIL_NULL(shader);
 	const TypedArray<ComputeShaderKernel>& kernels = shader->get_kernels();
-	for (int64_t i = 0; i < kernels.size(); i++) {
-		_dispatch(i, thread_groups, context);
-	}
+	std::vector<int64_t> kernel_indices(kernels.size());
+	std::iota(kernel_indices.begin(), kernel_indices.end(), 0);
+	_dispatch(kernel_indices, thread_groups, context);
 }
 
 void ComputeShaderTask::dispatch(const StringName& kernel_name, const Vector3i thread_groups, const Object* context) {
 	std::lock_guard lock(*_mutex.ptr());
 	ERR_FAIL_NULL(shader);
-	const TypedArray<ComputeShaderKernel>& kernels = shader->get_kernels();
-	for (int64_t i = 0; i < kernels.size(); i++) {
-		Ref<ComputeShaderKernel> kernel = kernels[i];
-		if (kernel.is_valid() && kernel->get_kernel_name() == kernel_name) {
-			_dispatch(i, thread_groups, context);
-		}
+	for (const int64_t kernel_index : _find_kernel_indices(kernel_name)) {
+		_dispatch(kernel_index, thread_groups, context);
 	}
 }
 
@@ -202,19 +232,90 @@ void ComputeShaderTask::dispatch_at(const int64_t kernel_index, const Vector3i t
 void ComputeShaderTask::dispatch_group(const StringName& group_name, const Vector3i thread_groups, const Object* context) {
 	std::lock_guard lock(*_mutex.ptr());
 	ERR_FAIL_NULL(shader);
-	const TypedArray<ComputeShaderKernel>& kernels = shader->get_kernels();
-	for (int64_t i = 0; i < kernels.size(); i++) {
-		const Ref<ComputeShaderKernel> kernel = kernels[i];
-		if (kernel.is_valid()) {
-			const Dictionary attributes = kernel->get_user_attributes();
-			if (attributes.has(GodotAttributes::kernel_group())) {
-				const Dictionary kernel_group_attr = attributes[GodotAttributes::kernel_group()];
-				if (kernel_group_attr["group_name"] == group_name) {
-					_dispatch(i, thread_groups, context);
-				}
-			}
+	if (const int64_t group_id = get_kernel_group_id(group_name); group_id >= 0) {
+		_dispatch(_kernel_groups[group_id], thread_groups, context);
+	}
+}
+
+void ComputeShaderTask::dispatch_group_by_id(const int64_t group_id, const Vector3i thread_groups, const Object* context) {
+	std::lock_guard lock(*_mutex.ptr());
+	ERR_FAIL_NULL(shader);
+	ERR_FAIL_INDEX_MSG(group_id, static_cast<int64_t>(_kernel_groups.size()), String("Attempted to dispatch invalid kernel group id %s!") % String::num_int64(group_id));
+	_dispatch(_kernel_groups[group_id], thread_groups, context);
+}
+
+void ComputeShaderTask::dispatch_indirect(const StringName& kernel_name, const StringName& args_param, const int64_t byte_offset, const Object* context) {
+	std::lock_guard lock(*_mutex.ptr());
+	if (shader.is_null() || !_shader_object)
+		return;
+	const int64_t kernel_index = _find_kernel_index(kernel_name);
+	ERR_FAIL_COND_MSG(kernel_index < 0, String("No such kernel '%s'!") % kernel_name);
+	ERR_FAIL_COND_MSG(byte_offset < 0 || byte_offset % 4 != 0, "Indirect dispatch byte_offset must be a non-negative multiple of 4!");
+	_dispatch_indirect(kernel_index, args_param, byte_offset, context);
+}
+
+void ComputeShaderTask::_dispatch_indirect(const int64_t kernel_index, const StringName& args_param, const int64_t byte_offset, const Object* context) {
+	RenderingDevice* rendering_device = _get_active_rendering_device();
+	ERR_FAIL_NULL_MSG(rendering_device, "ComputeShaderTask: Couldn't obtain rendering device for dispatch!");
+
+	const std::vector<DispatchKernel> dispatch_kernels = _prepare_dispatch(std::span(&kernel_index, 1), context);
+	if (dispatch_kernels.empty())
+		return;
+	if (_reads_pending_uploads(dispatch_kernels)) {
+		_defer_dispatch(DeferredDispatch{ { kernel_index }, {}, context ? context->get_instance_id() : ObjectID{}, args_param, byte_offset });
+		return;
+	}
+
+	// resolved after the parameters are written, so the buffer exists even if it was only just set
+	KernelData* kernel_data = dispatch_kernels.front().second;
+	// global parameters first, then the kernel's own parameters
+	ComputeShaderObject* args_object = _shader_object.get();
+	const StringName args_root = split_path(args_param).front();
+	if (!args_object->get_shape()->find_field(args_root) && kernel_data->shader_object) {
+		args_object = kernel_data->shader_object.get();
+	}
+	const TypedArray<RID> args_rids = ComputeShaderCursor(args_object).path(args_param).get_rids();
+	ERR_FAIL_COND_MSG(args_rids.is_empty(), String("Indirect dispatch arguments '%s' must be a buffer parameter!") % args_param);
+	const RID args_buffer = args_rids.front();
+	ERR_FAIL_COND_MSG(!args_buffer.is_valid(), String("Indirect dispatch arguments '%s' have no buffer!") % args_param);
+
+	const int64_t compute_list = rendering_device->compute_list_begin();
+	_bind_kernel(rendering_device, compute_list, kernel_data);
+	rendering_device->compute_list_dispatch_indirect(compute_list, args_buffer, byte_offset);
+	rendering_device->compute_list_end();
+}
+
+void ComputeShaderTask::warmup(const TypedArray<StringName>& kernels) {
+	std::lock_guard lock(*_mutex.ptr());
+	ERR_FAIL_NULL(shader);
+	if (kernels.is_empty()) {
+		for (int64_t i = 0; i < shader->get_kernels().size(); i++) {
+			_warmup_queue.push_back(i);
+		}
+	} else {
+		for (const StringName kernel_name : kernels) {
+			const std::span<const int64_t> kernel_indices = _find_kernel_indices(kernel_name);
+			ERR_CONTINUE_MSG(kernel_indices.empty(), String("No such kernel '%s'!") % kernel_name);
+			_warmup_queue.insert(_warmup_queue.end(), kernel_indices.begin(), kernel_indices.end());
 		}
 	}
+	RenderingServer* rendering_server = RenderingServer::get_singleton();
+	ERR_FAIL_NULL(rendering_server);
+	const Callable callable = callable_mp(this, &ComputeShaderTask::_warmup_step);
+	if (!rendering_server->is_connected("frame_pre_draw", callable)) {
+		rendering_server->connect("frame_pre_draw", callable);
+	}
+}
+
+int64_t ComputeShaderTask::get_kernel_group_id(const StringName& group_name) const {
+	std::lock_guard lock(*_mutex.ptr());
+	const auto group_id = _kernel_group_ids.find(group_name);
+	return group_id != _kernel_group_ids.end() ? group_id->value : -1;
+}
+
+int64_t ComputeShaderTask::get_pending_upload_bytes() const {
+	std::lock_guard lock(*_mutex.ptr());
+	return _get_pending_upload_bytes();
 }
 
 TypedArray<RID> ComputeShaderTask::get_rids(const StringName& param) const {
@@ -247,16 +348,16 @@ Dictionary ComputeShaderTask::get_kernel_parameters(const StringName& kernel_nam
 	if (shader.is_null()) {
 		return {};
 	}
-	for (const Ref<ComputeShaderKernel> kernel : shader->get_kernels()) {
-		if (kernel->get_kernel_name() == kernel_name) {
-			const Ref<StructTypeLayoutShape> params_shape = kernel->get_parameters();
-			if (params_shape.is_null()) {
-				return {};
-			}
-			return params_shape->get_properties().duplicate();
-		}
+	const int64_t kernel_index = _find_kernel_index(kernel_name);
+	if (kernel_index < 0) {
+		return {};
 	}
-	return {};
+	const Ref<ComputeShaderKernel> kernel = shader->get_kernels()[kernel_index];
+	const Ref<StructTypeLayoutShape> params_shape = kernel.is_valid() ? kernel->get_parameters() : nullptr;
+	if (params_shape.is_null()) {
+		return {};
+	}
+	return params_shape->get_properties().duplicate();
 }
 
 TypedArray<RID> ComputeShaderTask::get_kernel_rids(const StringName& kernel, const StringName& param) const {
@@ -441,21 +542,199 @@ void ComputeShaderTask::_reset() {
 	for (int64_t i = 0; i < num_kernels; i++) {
 		_kernel_data[i] = nullptr;
 	}
+	_upload_total = 0;
+	// kernel indices may refer to different kernels from now on
+	_deferred_dispatches.clear();
 	RenderingDevice* rd = _get_active_rendering_device();
 	ERR_FAIL_NULL_MSG(rd, "ComputeShaderTask: Couldn't obtain rendering device for reset!");
 	_sampler_cache = std::make_unique<SamplerCache>(rd);
+	_uniform_set_cache = std::make_unique<UniformSetCache>(rd);
 	if (shader.is_valid() && shader->get_base_error().is_empty() && shader->get_parameters().is_valid()) {
 		_shader_object = std::make_unique<ComputeShaderObject>(rd, _sampler_cache.get(), shader->get_parameters());
+		_write_plan = std::make_unique<ComputeShaderWritePlan>(_shader_object.get());
+		_handle_plan_entries.clear();
 	} else {
+		_write_plan = nullptr;
 		_shader_object = nullptr;
 	}
 }
 
 void ComputeShaderTask::_shader_changed() {
+	_rebuild_kernel_tables();
 	_reset();
 	notify_property_list_changed();
 }
 
+void ComputeShaderTask::_rebuild_kernel_tables() {
+	std::lock_guard lock(*_mutex.ptr());
+	_kernel_indices.clear();
+	_kernel_group_ids.clear();
+	_kernel_groups.clear();
+	if (shader.is_null())
+		return;
+	const TypedArray<ComputeShaderKernel>& kernels = shader->get_kernels();
+	for (int64_t i = 0; i < kernels.size(); i++) {
+		const Ref<ComputeShaderKernel> kernel = kernels[i];
+		if (kernel.is_null())
+			continue;
+		_kernel_indices[kernel->get_kernel_name()].push_back(i);
+		const Dictionary attributes = kernel->get_user_attributes();
+		if (attributes.has(GodotAttributes::kernel_group())) {
+			const Dictionary kernel_group_attr = attributes[GodotAttributes::kernel_group()];
+			const StringName group_name = kernel_group_attr["group_name"];
+			if (!_kernel_group_ids.has(group_name)) {
+				_kernel_group_ids.insert(group_name, _kernel_groups.size());
+				_kernel_groups.emplace_back();
+			}
+			_kernel_groups[_kernel_group_ids[group_name]].push_back(i);
+		}
+	}
+}
+
+void ComputeShaderTask::_warmup_step() {
+	std::lock_guard lock(*_mutex.ptr());
+	// create at most one shader and pipeline per frame to avoid trading one hitch for another
+	if (shader.is_null()) {
+		_warmup_queue.clear();
+	}
+	while (!_warmup_queue.empty()) {
+		const int64_t kernel_index = _warmup_queue.front();
+		_warmup_queue.erase(_warmup_queue.begin());
+		// the shader may have changed since the kernel was queued
+		if (kernel_index >= static_cast<int64_t>(_kernel_data.size()) || _kernel_data[kernel_index])
+			continue;
+		const Ref<ComputeShaderKernel> kernel = shader->get_kernels()[kernel_index];
+		if (kernel.is_null() || !kernel->get_compile_error().is_empty())
+			continue;
+		_get_or_create_kernel(kernel_index);
+		break;
+	}
+	if (_warmup_queue.empty()) {
+		RenderingServer::get_singleton()->disconnect("frame_pre_draw", callable_mp(this, &ComputeShaderTask::_warmup_step));
+		call_deferred("emit_signal", "warmup_completed");
+	}
+}
+
+void ComputeShaderTask::_upload_step() {
+	std::lock_guard lock(*_mutex.ptr());
+	// flushing again uploads the next part of every streamed buffer within what is left of this frame's budget
+	std::vector<KernelData*> kernel_datas{};
+	for (const std::unique_ptr<KernelData>& kernel_data : _kernel_data) {
+		if (kernel_data) {
+			kernel_datas.push_back(kernel_data.get());
+		}
+	}
+	_flush_buffers(kernel_datas);
+	const int64_t pending_bytes = _get_pending_upload_bytes();
+	_upload_total = Math::max(_upload_total, pending_bytes);
+	call_deferred("emit_signal", "upload_progressed", _upload_total - pending_bytes, _upload_total);
+	if (pending_bytes == 0) {
+		_upload_total = 0;
+		RenderingServer::get_singleton()->disconnect("frame_pre_draw", callable_mp(this, &ComputeShaderTask::_upload_step));
+		call_deferred("emit_signal", "upload_completed");
+		_replay_deferred_dispatches();
+	}
+}
+
+void ComputeShaderTask::_flush_buffers(const std::vector<KernelData*>& kernel_datas) {
+	if (!_shader_object)
+		return;
+	// every buffer of the task draws from one allowance per frame
+	int64_t remaining_budget = ComputeBuffer::UNLIMITED_UPLOAD_BUDGET;
+	if (upload_budget > 0) {
+		const uint64_t frame = Engine::get_singleton()->get_frames_drawn();
+		if (frame != _upload_frame) {
+			_upload_frame = frame;
+			_upload_frame_bytes = 0;
+		}
+		remaining_budget = Math::max<int64_t>(upload_budget - _upload_frame_bytes, 0);
+	}
+	const int64_t frame_budget = remaining_budget;
+	_shader_object->flush_buffers(remaining_budget);
+	for (KernelData* kernel_data : kernel_datas) {
+		kernel_data->shader_object->flush_buffers(remaining_budget);
+	}
+	if (upload_budget > 0) {
+		_upload_frame_bytes += frame_budget - remaining_budget;
+	}
+}
+
+void ComputeShaderTask::_track_uploads() {
+	const int64_t pending_bytes = _get_pending_upload_bytes();
+	if (pending_bytes == 0)
+		return;
+	_upload_total = Math::max(_upload_total, pending_bytes);
+	RenderingServer* rendering_server = RenderingServer::get_singleton();
+	ERR_FAIL_NULL(rendering_server);
+	const Callable callable = callable_mp(this, &ComputeShaderTask::_upload_step);
+	if (!rendering_server->is_connected("frame_pre_draw", callable)) {
+		rendering_server->connect("frame_pre_draw", callable);
+	}
+}
+
+int64_t ComputeShaderTask::_get_pending_upload_bytes() const {
+	int64_t pending_bytes = _shader_object ? _shader_object->get_pending_upload_bytes() : 0;
+	for (const std::unique_ptr<KernelData>& kernel_data : _kernel_data) {
+		if (kernel_data) {
+			pending_bytes += kernel_data->shader_object->get_pending_upload_bytes();
+		}
+	}
+	return pending_bytes;
+}
+
+void ComputeShaderTask::_defer_dispatch(DeferredDispatch&& dispatch) {
+	// repeated dispatches, e.g. one per frame while the upload is streaming, only run once
+	if (std::find(_deferred_dispatches.begin(), _deferred_dispatches.end(), dispatch) == _deferred_dispatches.end()) {
+		_deferred_dispatches.push_back(std::move(dispatch));
+	}
+}
+
+void ComputeShaderTask::_replay_deferred_dispatches() {
+	std::vector<DeferredDispatch> dispatches{};
+	dispatches.swap(_deferred_dispatches);
+	for (const DeferredDispatch& dispatch : dispatches) {
+		const Object* context = ObjectDB::get_instance(dispatch.context);
+		// the context was freed in the meantime, so the dispatch can no longer bind its data
+		if (dispatch.context.is_valid() && !context)
+			continue;
+		if (dispatch.args_param.is_empty()) {
+			_dispatch(dispatch.kernel_indices, dispatch.thread_groups, context);
+		} else {
+			_dispatch_indirect(dispatch.kernel_indices.front(), dispatch.args_param, dispatch.byte_offset, context);
+		}
+	}
+}
+
+bool ComputeShaderTask::_reads_pending_uploads(const std::vector<DispatchKernel>& dispatch_kernels) const {
+	if (_upload_total == 0)
+		return false;
+	std::vector<RID> pending_rids{};
+	_shader_object->get_pending_upload_rids(pending_rids);
+	for (const auto& [kernel, kernel_data] : dispatch_kernels) {
+		kernel_data->shader_object->get_pending_upload_rids(pending_rids);
+	}
+	if (pending_rids.empty())
+		return false;
+	for (const auto& [kernel, kernel_data] : dispatch_kernels) {
+		for (const ComputeShaderObject::ResourceAccess& access : _get_resource_accesses(kernel, kernel_data)) {
+			if (std::find(pending_rids.begin(), pending_rids.end(), access.rid) != pending_rids.end()) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+int64_t ComputeShaderTask::_find_kernel_index(const StringName& kernel_name) const {
+	const std::span<const int64_t> kernel_indices = _find_kernel_indices(kernel_name);
+	return kernel_indices.empty() ? -1 : kernel_indices.front();
+}
+
+std::span<const int64_t> ComputeShaderTask::_find_kernel_indices(const StringName& kernel_name) const {
+	const auto kernel_indices = _kernel_indices.find(kernel_name);
+	return kernel_indices != _kernel_indices.end() ? std::span<const int64_t>(kernel_indices->value) : std::span<const int64_t>();
+}
+
 RenderingDevice* ComputeShaderTask::_get_active_rendering_device() const {
 	if (RenderingDevice* rendering_device = get_rendering_device()) {
 		return rendering_device;
@@ -476,66 +755,273 @@ ComputeShaderTask::KernelData* ComputeShaderTask::_get_or_create_kernel(const in
 	const TypedArray<ComputeShaderKernel>& kernels = shader->get_kernels();
 	ERR_FAIL_INDEX_V(kernel_index, kernels.size(), nullptr);
 	const Ref<ComputeShaderKernel> kernel = kernels[kernel_index];
-	const RID shader_rid = rd->shader_create_from_spirv(kernel->get_spirv(), shader->get_name().get_file());
+	const RID shader_rid = kernel->create_shader(rd, shader->get_name().get_file());
+	ERR_FAIL_COND_V_MSG(!shader_rid.is_valid(), nullptr, String("Failed to create shader for kernel '%s'!") % kernel->get_kernel_name());
 	kernel_data = std::make_unique<KernelData>(KernelData{
 		UniqueRID(rd, shader_rid),
 		UniqueRID(rd, rd->compute_pipeline_create(shader_rid)),
 		std::make_unique<ComputeShaderObject>(rd, _sampler_cache.get(), kernel->get_parameters(), kernel->get_space_offset(), kernel->get_slot_offset()),
 	});
+	kernel_data->write_plan = std::make_unique<ComputeShaderWritePlan>(kernel_data->shader_object.get());
+	if (_shader_object) {
+		_build_uniform_sets(kernel, kernel_data.get());
+	}
 	return kernel_data.get();
 }
 
 ComputeShaderTask::KernelData* ComputeShaderTask::_get_kernel_data(const StringName& kernel_name) const {
 	if (shader.is_null())
 		return nullptr;
-	TypedArray<ComputeShaderKernel> kernels = shader->get_kernels();
-	for (int64_t i = 0; i < kernels.size(); i++) {
-		Ref<ComputeShaderKernel> kernel = kernels[i];
-		if (kernel.is_valid() && kernel->get_kernel_name() == kernel_name) {
-			ERR_FAIL_INDEX_V(i, _kernel_data.size(), {});
-			return _kernel_data[i].get();
-		}
-	}
-	return nullptr;
+	const int64_t kernel_index = _find_kernel_index(kernel_name);
+	if (kernel_index < 0)
+		return nullptr;
+	ERR_FAIL_INDEX_V(kernel_index, _kernel_data.size(), {});
+	return _kernel_data[kernel_index].get();
 }
 
 void ComputeShaderTask::_dispatch(const int64_t kernel_index, const Vector3i thread_groups, const Object* context) {
+	_dispatch(std::span(&kernel_index, 1), thread_groups, context);
+}
+
+void ComputeShaderTask::_dispatch(const std::span<const int64_t> kernel_indices, const Vector3i thread_groups, const Object* context) {
 	std::lock_guard lock(*_mutex.ptr());
-	if (shader.is_null() || !_shader_object)
+	if (shader.is_null() || !_shader_object || kernel_indices.empty())
 		return;
-	const TypedArray<ComputeShaderKernel>& kernels = shader->get_kernels();
-	ERR_FAIL_INDEX_MSG(kernel_index, kernels.size(), String("Attempted to dispatch invalid kernel index %s (max %s)!") % PackedStringArray({ String::num_int64(kernel_index), String::num_int64(kernels.size() - 1) }));
-
-	const Ref<ComputeShaderKernel> kernel = kernels[kernel_index];
-	ERR_FAIL_NULL_MSG(kernel, String("Attempted to dispatch invalid kernel index %s (found: nil)!") % String::num_int64(kernel_index));
-	ERR_FAIL_COND_MSG(!kernel->get_compile_error().is_empty(), "Can't dispatch kernel with compile error!");
 
 	RenderingDevice* rendering_device = _get_active_rendering_device();
 	ERR_FAIL_NULL_MSG(rendering_device, "ComputeShaderTask: Couldn't obtain rendering device for dispatch!");
 
-	const KernelData* kernel_data = _get_or_create_kernel(kernel_index);
-	ERR_FAIL_NULL_MSG(kernel_data, "ComputeShaderTask: Couldn't obtain kernel data!");
+	const std::vector<DispatchKernel> dispatch_kernels = _prepare_dispatch(kernel_indices, context);
+	if (dispatch_kernels.empty())
+		return;
+	// dispatches wait for the buffers they access to be streamed in completely
+	if (_reads_pending_uploads(dispatch_kernels)) {
+		_defer_dispatch(DeferredDispatch{ { kernel_indices.begin(), kernel_indices.end() }, thread_groups, context ? context->get_instance_id() : ObjectID{} });
+		return;
+	}
 
-	const Dictionary kernel_params = _kernel_parameters.has(kernel->get_kernel_name()) ? _kernel_parameters[kernel->get_kernel_name()] : Dictionary{};
-	ComputeShaderCursor(_shader_object.get(), context).write(_shader_parameters);
-	ComputeShaderCursor(kernel_data->shader_object.get(), context).write(kernel_params);
-	_shader_object->flush_buffers();
-	kernel_data->shader_object->flush_buffers();
+	std::unordered_set<RID, GodotHasher> written_rids{};
+	std::unordered_set<RID, GodotHasher> accessed_rids{};
 	const int64_t compute_list = rendering_device->compute_list_begin();
-	rendering_device->compute_list_bind_compute_pipeline(compute_list, kernel_data->pipeline_rid);
+	for (const auto& [kernel, kernel_data] : dispatch_kernels) {
+		if (dispatch_kernels.size() > 1) {
+			const std::vector<ComputeShaderObject::ResourceAccess> accesses = _get_resource_accesses(kernel, kernel_data);
+			const bool needs_barrier = std::any_of(accesses.begin(), accesses.end(), [&](const ComputeShaderObject::ResourceAccess& access) {
+				return written_rids.contains(access.rid) || (access.is_writable && accessed_rids.contains(access.rid));
+			});
+			if (needs_barrier) {
+				rendering_device->compute_list_add_barrier(compute_list);
+				written_rids.clear();
+				accessed_rids.clear();
+			}
+			for (const ComputeShaderObject::ResourceAccess& access : accesses) {
+				accessed_rids.insert(access.rid);
+				if (access.is_writable) {
+					written_rids.insert(access.rid);
+				}
+			}
+		}
+		_bind_kernel(rendering_device, compute_list, kernel_data);
+		rendering_device->compute_list_dispatch(compute_list, thread_groups.x, thread_groups.y, thread_groups.z);
+	}
+	rendering_device->compute_list_end();
+}
+
+std::vector<ComputeShaderTask::DispatchKernel> ComputeShaderTask::_prepare_dispatch(const std::span<const int64_t> kernel_indices, const Object* context) {
+	const TypedArray<ComputeShaderKernel>& kernels = shader->get_kernels();
+	std::vector<DispatchKernel> dispatch_kernels{};
+	dispatch_kernels.reserve(kernel_indices.size());
+	for (const int64_t kernel_index : kernel_indices) {
+		ERR_CONTINUE_MSG(kernel_index < 0 || kernel_index >= kernels.size(), String("Attempted to dispatch invalid kernel index %s (max %s)!") % PackedStringArray({ String::num_int64(kernel_index), String::num_int64(kernels.size() - 1) }));
+		const Ref<ComputeShaderKernel> kernel = kernels[kernel_index];
+		ERR_CONTINUE_MSG(kernel.is_null(), String("Attempted to dispatch invalid kernel index %s (found: nil)!") % String::num_int64(kernel_index));
+		ERR_CONTINUE_MSG(!kernel->get_compile_error().is_empty(), "Can't dispatch kernel with compile error!");
+		KernelData* kernel_data = _get_or_create_kernel(kernel_index);
+		ERR_CONTINUE_MSG(!kernel_data, "ComputeShaderTask: Couldn't obtain kernel data!");
+		dispatch_kernels.emplace_back(kernel, kernel_data);
+	}
+	if (dispatch_kernels.empty())
+		return {};
+
+	_apply_pending_changes();
+
+	// buffers can't be updated while a compute list is open, so every parameter is written and flushed up front
+	_write_plan->execute(_dispatch_shader_parameters, context);
+	std::vector<KernelData*> kernel_datas{};
+	for (const auto& [kernel, kernel_data] : dispatch_kernels) {
+		const Dictionary kernel_params = _dispatch_kernel_parameters.has(kernel->get_kernel_name()) ? _dispatch_kernel_parameters[kernel->get_kernel_name()] : Dictionary{};
+		kernel_data->write_plan->execute(kernel_params, context);
+		kernel_datas.push_back(kernel_data);
+	}
+	_flush_buffers(kernel_datas);
+	_track_uploads();
+	return dispatch_kernels;
+}
+
+void ComputeShaderTask::_queue_change(ParameterChange&& change) {
+	// the last write to a parameter wins, so a task that is written every frame but not dispatched doesn't accumulate changes
+	HashMap<StringName, size_t>& indices = _pending_change_indices[change.kernel];
+	if (const auto index = indices.find(change.param); index != indices.end()) {
+		if (index->value == _pending_changes.size() - 1) {
+			_pending_changes.back() = std::move(change);
+			return;
+		}
+		// changes to enclosing or nested parameters may have been queued since, so the new change goes last
+		_pending_changes[index->value].superseded = true;
+		++_superseded_changes;
+	}
+	indices[change.param] = _pending_changes.size();
+	_pending_changes.push_back(std::move(change));
+
+	if (_superseded_changes > _pending_changes.size() / 2) {
+		std::erase_if(_pending_changes, [](const ParameterChange& pending_change) {
+			return pending_change.superseded;
+		});
+		_superseded_changes = 0;
+		_pending_change_indices.clear();
+		for (size_t i = 0; i < _pending_changes.size(); ++i) {
+			if (!_pending_changes[i].clear) {
+				_pending_change_indices[_pending_changes[i].kernel][_pending_changes[i].param] = i;
+			}
+		}
+	}
+}
+
+void ComputeShaderTask::_apply_pending_changes() {
+	std::vector<ParameterChange> changes{};
+	{
+		// writers only ever wait for this swap, never for recording or submission
+		std::lock_guard lock(*_parameters_mutex.ptr());
+		changes.swap(_pending_changes);
+		_pending_change_indices.clear();
+		_superseded_changes = 0;
+	}
+	for (const ParameterChange& change : changes) {
+		if (change.superseded)
+			continue;
+		if (change.clear) {
+			_dispatch_shader_parameters.clear();
+			_dispatch_kernel_parameters.clear();
+			if (_write_plan) {
+				_write_plan->mark_all_dirty();
+			}
+			for (const std::unique_ptr<KernelData>& kernel_data : _kernel_data) {
+				if (kernel_data && kernel_data->write_plan) {
+					kernel_data->write_plan->mark_all_dirty();
+				}
+			}
+		} else if (change.handle >= 0) {
+			_set_parameter(_dispatch_shader_parameters, change.param_parts, change.value);
+			if (_write_plan) {
+				if (change.handle >= static_cast<int64_t>(_handle_plan_entries.size())) {
+					_handle_plan_entries.resize(change.handle + 1, UNRESOLVED_PLAN_ENTRY);
+				}
+				int64_t& plan_entry = _handle_plan_entries[change.handle];
+				if (plan_entry == UNRESOLVED_PLAN_ENTRY) {
+					plan_entry = _write_plan->find_entry(change.param_parts);
+				}
+				if (plan_entry >= 0) {
+					_write_plan->mark_entry_dirty(plan_entry);
+				}
+			}
+		} else if (change.kernel.is_empty()) {
+			_set_parameter(_dispatch_shader_parameters, change.param, change.value);
+			if (_write_plan) {
+				_write_plan->mark_dirty(change.param);
+			}
+		} else {
+			if (!_dispatch_kernel_parameters.has(change.kernel)) {
+				_dispatch_kernel_parameters[change.kernel] = Dictionary();
+			}
+			_set_parameter(_dispatch_kernel_parameters[change.kernel], change.param, change.value);
+			// every kernel with this name reads the same parameters
+			for (const int64_t kernel_index : _find_kernel_indices(change.kernel)) {
+				if (kernel_index < static_cast<int64_t>(_kernel_data.size()) && _kernel_data[kernel_index] && _kernel_data[kernel_index]->write_plan) {
+					_kernel_data[kernel_index]->write_plan->mark_dirty(change.param);
+				}
+			}
+		}
+	}
+}
 
-	ComputeShaderObject::DescriptorSets descriptor_sets{};
+Variant ComputeShaderTask::_get_parameter(const Dictionary& parameters, const StringName& param) {
+	const PackedStringArray parts = param.split("/");
+	Variant current = parameters;
+	int64_t i = 0;
+	bool valid;
+	for (; i < parts.size() - 1; ++i) {
+		current = current.get_named(parts[i], valid);
+		if (!valid || current.get_type() == Variant::NIL)
+			return {};
+	}
+	return current.get_named(parts[i], valid);
+}
+
+void ComputeShaderTask::_set_parameter(const Dictionary& parameters, const StringName& param, const Variant& value) {
+	_set_parameter(parameters, split_path(param), value);
+}
+
+void ComputeShaderTask::_set_parameter(const Dictionary& parameters, const std::span<const StringName> parts, const Variant& value) {
+	Variant current = parameters;
+	int64_t i = 0;
+	bool valid;
+	for (; i < static_cast<int64_t>(parts.size()) - 1; ++i) {
+		Variant next = current.get_named(parts[i], valid);
+		if (!valid || next.get_type() == Variant::NIL) {
+			next = Dictionary();
+			current.set_named(parts[i], next, valid);
+		}
+		current = next;
+	}
+	current.set_named(parts[i], value, valid);
+}
+
+Variant ComputeShaderTask::_snapshot_parameter(const Variant& value) {
+	// Array and Dictionary are shared by reference, so the render thread gets its own copy
+	switch (value.get_type()) {
+		case Variant::ARRAY:
+		case Variant::DICTIONARY:
+			return value.duplicate(true);
+		default:
+			return value;
+	}
+}
+
+void ComputeShaderTask::_build_uniform_sets(const Ref<ComputeShaderKernel>& kernel, KernelData* kernel_data) const {
+	ComputeShaderObject::DescriptorLayout layout{};
 	uint64_t next_space_index = 0;
-	const uint64_t active_space_index = _shader_object->get_descriptor_sets(descriptor_sets, next_space_index);
-	kernel_data->shader_object->get_descriptor_sets(descriptor_sets, active_space_index, next_space_index);
+	const uint64_t active_space_index = _shader_object->get_descriptor_layout(layout, next_space_index);
+	kernel_data->shader_object->get_descriptor_layout(layout, active_space_index, next_space_index);
 
 	const Dictionary used_binding_sets = kernel->get_used_binding_sets();
-	for (const auto& [space_index, uniforms] : descriptor_sets) {
+	kernel_data->uniform_sets.clear();
+	for (auto& [space_index, objects] : layout) {
 		if (used_binding_sets.get(space_index, false)) {
-			// TODO: UniformSetCacheRD only works with the default rendering device
-			const RID uniform_set = UniformSetCacheRD::get_cache(kernel_data->shader_rid, space_index, uniforms);
-			rendering_device->compute_list_bind_uniform_set(compute_list, uniform_set, space_index);
+			const size_t object_count = objects.size();
+			kernel_data->uniform_sets.push_back(BoundUniformSet{ space_index, std::move(objects), std::vector<uint64_t>(object_count), RID() });
+		}
+	}
+}
+
+void ComputeShaderTask::_bind_kernel(RenderingDevice* rendering_device, const int64_t compute_list, KernelData* kernel_data) {
+	rendering_device->compute_list_bind_compute_pipeline(compute_list, kernel_data->pipeline_rid);
+
+	for (BoundUniformSet& bound_set : kernel_data->uniform_sets) {
+		// the set is only looked up again if one of its resources changed, or the cache (or a freed resource) released it
+		bool is_current = bound_set.uniform_set.is_valid() && rendering_device->uniform_set_is_valid(bound_set.uniform_set);
+		for (size_t i = 0; i < bound_set.objects.size(); i++) {
+			const uint64_t version = bound_set.objects[i]->get_resource_version();
+			is_current = is_current && bound_set.versions[i] == version;
+			bound_set.versions[i] = version;
+		}
+		if (!is_current) {
+			std::vector<const UniformSlot*> uniforms{};
+			for (const ComputeShaderObject* object : bound_set.objects) {
+				object->append_uniforms(uniforms);
+			}
+			bound_set.uniform_set = _uniform_set_cache->get_uniform_set(kernel_data->shader_rid, bound_set.set_index, uniforms);
 		}
+		rendering_device->compute_list_bind_uniform_set(compute_list, bound_set.uniform_set, bound_set.set_index);
 	}
 
 	// from the docs:
@@ -546,7 +1032,16 @@ void ComputeShaderTask::_dispatch(const int64_t kernel_index, const Vector3i thr
 	} else if (const PackedByteArray& kernel_push_constants = kernel_data->shader_object->get_push_constants(); kernel_push_constants.size() > 0) {
 		rendering_device->compute_list_set_push_constant(compute_list, kernel_push_constants, kernel_push_constants.size());
 	}
+}
 
-	rendering_device->compute_list_dispatch(compute_list, thread_groups.x, thread_groups.y, thread_groups.z);
-	rendering_device->compute_list_end();
+std::vector<ComputeShaderObject::ResourceAccess> ComputeShaderTask::_get_resource_accesses(const Ref<ComputeShaderKernel>& kernel, const KernelData* kernel_data) const {
+	std::vector<ComputeShaderObject::ResourceAccess> accesses{};
+	uint64_t next_space_index = 0;
+	const uint64_t active_space_index = _shader_object->get_resource_accesses(accesses, next_space_index);
+	kernel_data->shader_object->get_resource_accesses(accesses, active_space_index, next_space_index);
+	const Dictionary used_binding_sets = kernel->get_used_binding_sets();
+	std::erase_if(accesses, [&used_binding_sets](const ComputeShaderObject::ResourceAccess& access) {
+		return !used_binding_sets.get(access.space_index, false);
+	});
+	return accesses;
 }
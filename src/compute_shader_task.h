@@ -4,24 +4,30 @@
 #include "godot_cpp/classes/resource.hpp"
 #include "godot_cpp/variant/typed_array.hpp"
 #include "memory"
+#include "span"
+#include "vector"
 
 #include "binding_macros.h"
 #include "compute_shader_cursor.h"
 #include "compute_shader_file.h"
 #include "compute_shader_shape.h"
+#include "compute_shader_write_plan.h"
 #include "sampler_cache.h"
+#include "uniform_set_cache.h"
 
 class ComputeShaderTask : public godot::Resource {
 	GDCLASS(ComputeShaderTask, Resource);
 
 	GET_SET_PROPERTY(godot::Ref<ComputeShaderFile>, shader)
 	GET_SET_OBJECT_PTR(godot::RenderingDevice, rendering_device)
+	GET_SET_PROPERTY(int64_t, upload_budget)
 
 protected:
 	static void _bind_methods();
 
 public:
 	ComputeShaderTask();
+	~ComputeShaderTask() override;
 
 	[[nodiscard]] godot::TypedArray<ComputeShaderKernel> get_kernels() const;
 
@@ -29,6 +35,9 @@ public:
 	void set_shader_parameter(const godot::StringName& param, const godot::Variant& value);
 	void clear_shader_parameters();
 
+	[[nodiscard]] int64_t get_parameter_handle(const godot::StringName& param);
+	void set_parameter_by_handle(int64_t handle, const godot::Variant& value);
+
 	[[nodiscard]] godot::Variant get_kernel_parameter(const godot::StringName& kernel, const godot::StringName& param) const;
 	void set_kernel_parameter(const godot::StringName& kernel, const godot::StringName& param, const godot::Variant& value);
 
@@ -36,6 +45,12 @@ public:
 	void dispatch(const godot::StringName& kernel_name, godot::Vector3i thread_groups, const Object* context = nullptr);
 	void dispatch_at(int64_t kernel_index, godot::Vector3i thread_groups, const Object* context = nullptr);
 	void dispatch_group(const godot::StringName& group_name, godot::Vector3i thread_groups, const Object* context = nullptr);
+	void dispatch_group_by_id(int64_t group_id, godot::Vector3i thread_groups, const Object* context = nullptr);
+	void warmup(const godot::TypedArray<godot::StringName>& kernels = {});
+
+	void dispatch_indirect(const godot::StringName& kernel_name, const godot::StringName& args_param, int64_t byte_offset = 0, const Object* context = nullptr);
+	[[nodiscard]] int64_t get_kernel_group_id(const godot::StringName& group_name) const;
+	[[nodiscard]] int64_t get_pending_upload_bytes() const;
 
 	godot::TypedArray<godot::RID> get_rids(const godot::StringName& param) const;
 	godot::PackedByteArray get_buffer_data(const godot::StringName& param) const;
@@ -59,26 +74,122 @@ public:
 	bool _property_get_reflection(const godot::StringName& p_name, FieldShape& r_reflection) const;
 
 private:
+	struct BoundUniformSet {
+		uint64_t set_index{};
+		// objects whose uniforms make up the set, and their resource versions when it was last resolved
+		std::vector<ComputeShaderObject*> objects{};
+		std::vector<uint64_t> versions{};
+		godot::RID uniform_set{};
+	};
+
 	struct KernelData {
 		UniqueRID<godot::RenderingDevice> shader_rid{};
 		UniqueRID<godot::RenderingDevice> pipeline_rid{};
 		std::unique_ptr<ComputeShaderObject> shader_object{};
+		std::unique_ptr<ComputeShaderWritePlan> write_plan{};
+		// the sets used by the kernel, laid out once when the kernel is created
+		std::vector<BoundUniformSet> uniform_sets{};
+	};
+	using DispatchKernel = std::pair<godot::Ref<ComputeShaderKernel>, KernelData*>;
+
+	struct ParameterChange {
+		// empty for global parameters
+		godot::StringName kernel{};
+		godot::StringName param{};
+		godot::Variant value{};
+		bool clear{};
+		// set through set_parameter_by_handle, which pre-splits param
+		int64_t handle = -1;
+		std::vector<godot::StringName> param_parts{};
+		// replaced by a later change to the same parameter
+		bool superseded{};
 	};
+
+	struct ParameterHandle {
+		godot::StringName param{};
+		std::vector<godot::StringName> param_parts{};
+	};
+
+	// parameters as set by the game, guarded by _parameters_mutex
 	godot::Dictionary _shader_parameters{};
 	godot::HashMap<godot::StringName, godot::Dictionary> _kernel_parameters{};
+	std::vector<ParameterChange> _pending_changes{};
+	// index of the latest pending change of each parameter, keyed by kernel (empty for globals) and then parameter
+	godot::HashMap<godot::StringName, godot::HashMap<godot::StringName, size_t>> _pending_change_indices{};
+	size_t _superseded_changes{};
+	std::vector<ParameterHandle> _parameter_handles{};
+	godot::HashMap<godot::StringName, int64_t> _parameter_handle_ids{};
+	godot::Ref<godot::Mutex> _parameters_mutex;
+
+	// parameters as seen by dispatch, only updated from _pending_changes while _mutex is held
+	godot::Dictionary _dispatch_shader_parameters{};
+	godot::HashMap<godot::StringName, godot::Dictionary> _dispatch_kernel_parameters{};
+	// write plan entry of each parameter handle, resolved on first use
+	std::vector<int64_t> _handle_plan_entries{};
+	static constexpr int64_t UNRESOLVED_PLAN_ENTRY = -2;
 	std::vector<std::unique_ptr<KernelData>> _kernel_data{};
 
+	// every kernel with a given name, in declaration order
+	godot::HashMap<godot::StringName, std::vector<int64_t>> _kernel_indices{};
+	godot::HashMap<godot::StringName, int64_t> _kernel_group_ids{};
+	std::vector<std::vector<int64_t>> _kernel_groups{};
+
+	// kernels still to be created by warmup, one per frame
+	std::vector<int64_t> _warmup_queue{};
+	// dispatches that accessed a buffer still being streamed in, replayed once every upload completed
+	struct DeferredDispatch {
+		std::vector<int64_t> kernel_indices{};
+		godot::Vector3i thread_groups{};
+		godot::ObjectID context{};
+		// set for dispatch_indirect
+		godot::StringName args_param{};
+		int64_t byte_offset{};
+
+		bool operator==(const DeferredDispatch&) const = default;
+	};
+	std::vector<DeferredDispatch> _deferred_dispatches{};
+	// bytes pending when the current streaming upload started, plus any added since
+	int64_t _upload_total{};
+	// bytes uploaded during _upload_frame, counted against upload_budget
+	uint64_t _upload_frame{};
+	int64_t _upload_frame_bytes{};
+
 	std::unique_ptr<SamplerCache> _sampler_cache;
+	std::unique_ptr<UniformSetCache> _uniform_set_cache;
 	std::unique_ptr<ComputeShaderObject> _shader_object;
+	std::unique_ptr<ComputeShaderWritePlan> _write_plan;
 
 	godot::Ref<godot::Mutex> _mutex;
 
 	void _reset();
 	void _shader_changed();
+	void _rebuild_kernel_tables();
+	[[nodiscard]] int64_t _find_kernel_index(const godot::StringName& kernel_name) const;
+	[[nodiscard]] std::span<const int64_t> _find_kernel_indices(const godot::StringName& kernel_name) const;
+	void _warmup_step();
+	void _upload_step();
+	void _flush_buffers(const std::vector<KernelData*>& kernel_datas);
+	void _track_uploads();
+	[[nodiscard]] int64_t _get_pending_upload_bytes() const;
+	[[nodiscard]] bool _reads_pending_uploads(const std::vector<DispatchKernel>& dispatch_kernels) const;
+	void _defer_dispatch(DeferredDispatch&& dispatch);
+	void _replay_deferred_dispatches();
 
 	godot::RenderingDevice* _get_active_rendering_device() const;
 	KernelData* _get_or_create_kernel(int64_t kernel_index);
 	KernelData* _get_kernel_data(const godot::StringName& kernel_name) const;
 
 	void _dispatch(int64_t kernel_index, godot::Vector3i thread_groups, const Object* context = nullptr);
+	void _dispatch(std::span<const int64_t> kernel_indices, godot::Vector3i thread_groups, const Object* context = nullptr);
+	void _dispatch_indirect(int64_t kernel_index, const godot::StringName& args_param, int64_t byte_offset, const Object* context = nullptr);
+	void _queue_change(ParameterChange&& change);
+	void _apply_pending_changes();
+	static godot::Variant _get_parameter(const godot::Dictionary& parameters, const godot::StringName& param);
+	static void _set_parameter(const godot::Dictionary& parameters, const godot::StringName& param, const godot::Variant& value);
+	static void _set_parameter(const godot::Dictionary& parameters, std::span<const godot::StringName> parts, const godot::Variant& value);
+	static godot::Variant _snapshot_parameter(const godot::Variant& value);
+	std::vector<DispatchKernel> _prepare_dispatch(std::span<const int64_t> kernel_indices, const Object* context);
+	void _build_uniform_sets(const godot::Ref<ComputeShaderKernel>& kernel, KernelData* kernel_data) const;
+	void _bind_kernel(godot::RenderingDevice* rendering_device, int64_t compute_list, KernelData* kernel_data);
+	std::vector<ComputeShaderObject::ResourceAccess> _get_resource_accesses(const godot::Ref<ComputeShaderKernel>& kernel, const KernelData* kernel_data) const;
 };
@@ -0,0 +1,187 @@
+#include "compute_shader_write_plan.h"
+
+#include "godot_cpp/classes/rd_uniform.hpp"
+
+#include "attributes.h"
+#include "compute_buffer_view.h"
+#include "variant_utils.h"
+
+using namespace godot;
+
+ComputeShaderWritePlan::ComputeShaderWritePlan(ComputeShaderObject* p_object) {
+	ERR_FAIL_NULL(p_object);
+	_compile(ComputeShaderCursor(p_object), NO_PARENT);
+	dirty_flags.resize(entries.size(), DIRTY);
+}
+
+int64_t ComputeShaderWritePlan::find_entry(const std::span<const StringName> parts) const {
+	uint32_t begin = 0;
+	uint32_t end = entries.size();
+	for (size_t part_index = 0; part_index < parts.size(); ++part_index) {
+		const StringName& key = parts[part_index];
+		uint32_t entry_index = begin;
+		while (entry_index < end && entries[entry_index].key != key) {
+			entry_index = entries[entry_index].end;
+		}
+		if (entry_index >= end)
+			return -1;
+		const Entry& entry = entries[entry_index];
+		if (entry.kind == EntryKind::GROUP && part_index < parts.size() - 1) {
+			begin = entry_index + 1;
+			end = entry.end;
+			continue;
+		}
+		// writing into a value that isn't flattened (e.g. an array element) rewrites the whole entry
+		return entry_index;
+	}
+	return -1;
+}
+
+void ComputeShaderWritePlan::mark_dirty(const StringName& path) {
+	if (const int64_t entry_index = find_entry(gdslang::split_path(path)); entry_index >= 0) {
+		_mark_dirty(entry_index);
+	}
+}
+
+void ComputeShaderWritePlan::mark_entry_dirty(const uint32_t entry_index) {
+	_mark_dirty(entry_index);
+}
+
+void ComputeShaderWritePlan::mark_all_dirty() {
+	std::fill(dirty_flags.begin(), dirty_flags.end(), DIRTY);
+}
+
+void ComputeShaderWritePlan::execute(const Variant& data, const Object* context) {
+	_execute(0, entries.size(), data, context);
+	_write_element_counts();
+}
+
+void ComputeShaderWritePlan::_compile(const ComputeShaderCursor& cursor, const uint32_t parent) {
+	const auto struct_shape = Object::cast_to<StructTypeLayoutShape>(cursor.get_shape().ptr());
+	ERR_FAIL_NULL(struct_shape);
+	for (const FieldShape& field : struct_shape->get_fields()) {
+		const ComputeShaderCursor field_cursor = cursor.field(field.name);
+		const Ref<ShaderTypeLayoutShape> field_shape = field_cursor.get_shape();
+		if (field_shape.is_null())
+			continue;
+
+		const uint32_t entry_index = entries.size();
+		entries.push_back(Entry{ field.name, EntryKind::GENERIC, entry_index + 1, parent, 0, ShaderTypeLayoutShape::MatrixLayout::ROW_MAJOR, false, false, field_cursor });
+		if (Object::cast_to<StructTypeLayoutShape>(field_shape.ptr()) && !field_cursor.has_write_handlers()) {
+			entries[entry_index].kind = EntryKind::GROUP;
+			_compile(field_cursor, entry_index);
+			entries[entry_index].end = entries.size();
+			for (uint32_t nested_index = entry_index + 1; nested_index < entries.size(); ++nested_index) {
+				entries[entry_index].contains_always_write |= entries[nested_index].always_write;
+			}
+		} else if (const auto variant_shape = Object::cast_to<VariantTypeLayoutShape>(field_shape.ptr()); variant_shape && variant_shape->get_size() > 0) {
+			entries[entry_index].kind = EntryKind::VALUE;
+			entries[entry_index].size = variant_shape->get_size();
+			entries[entry_index].matrix_layout = variant_shape->get_matrix_layout();
+			entries[entry_index].always_write = field_cursor.has_write_handlers();
+		} else {
+			entries[entry_index].always_write = field_cursor.has_write_handlers() || _has_nested_write_handlers(field_shape);
+		}
+		entries[entry_index].contains_always_write |= entries[entry_index].always_write;
+
+		if (const Variant element_count = field.user_attributes.get(GodotAttributes::element_count(), Variant()); element_count.get_type() == Variant::DICTIONARY) {
+			const StringName source_name = Dictionary(element_count).get("name", StringName());
+			ERR_CONTINUE_MSG(entries[entry_index].kind != EntryKind::VALUE, String("[gd::ElementCount] field '%s' must be a scalar!") % field.name);
+			ERR_CONTINUE_MSG(!struct_shape->find_field(source_name), String("No such field '%s'!") % source_name);
+			element_counts.push_back(ElementCountEntry{ entry_index, cursor.field(source_name) });
+		}
+	}
+}
+
+void ComputeShaderWritePlan::_execute(const uint32_t begin, const uint32_t end, const Variant& data, const Object* context) {
+	uint32_t entry_index = begin;
+	while (entry_index < end) {
+		const Entry& entry = entries[entry_index];
+		uint8_t flags = dirty_flags[entry_index];
+		bool is_valid{};
+		Variant value = data.get_named(entry.key, is_valid);
+		const bool is_object = value.get_type() == Variant::OBJECT && !_is_uniform(value);
+		if (flags == CLEAN && !entry.contains_always_write) {
+			if (!is_object) {
+				entry_index = entry.end;
+				continue;
+			}
+			// objects may change in place without the parameter being set again
+			flags = DIRTY;
+			std::fill(dirty_flags.begin() + entry_index + 1, dirty_flags.begin() + entry.end, DIRTY);
+		}
+		dirty_flags[entry_index] = CLEAN;
+		if (entry.kind == EntryKind::GROUP) {
+			const Variant::Type type = value.get_type();
+			if (type == Variant::NIL || type == Variant::DICTIONARY || is_object) {
+				_execute(entry_index + 1, entry.end, value, context);
+			} else if (flags & DIRTY) {
+				entry.cursor.with_context(context).write(value);
+			}
+		} else {
+			_execute_entry(entry, value, context);
+		}
+		entry_index = entry.end;
+	}
+}
+
+void ComputeShaderWritePlan::_mark_dirty(const uint32_t entry_index) {
+	ERR_FAIL_INDEX(entry_index, entries.size());
+	std::fill(dirty_flags.begin() + entry_index, dirty_flags.begin() + entries[entry_index].end, DIRTY);
+	for (uint32_t parent = entries[entry_index].parent; parent != NO_PARENT; parent = entries[parent].parent) {
+		dirty_flags[parent] |= NESTED_DIRTY;
+	}
+}
+
+void ComputeShaderWritePlan::_execute_entry(const Entry& entry, Variant& value, const Object* context) {
+	if (entry.kind == EntryKind::GENERIC) {
+		entry.cursor.with_context(context).write(value);
+		return;
+	}
+	entry.cursor.apply_write_handlers(value, context);
+	switch (value.get_type()) {
+		case Variant::PACKED_BYTE_ARRAY:
+		case Variant::RID:
+		case Variant::OBJECT:
+			entry.cursor.write_value(value);
+			break;
+		default:
+			entry.cursor.write_bytes(value, entry.size, entry.matrix_layout);
+			break;
+	}
+}
+
+bool ComputeShaderWritePlan::_is_uniform(const Variant& value) {
+	return Object::cast_to<RDUniform>(value) || Object::cast_to<ComputeBufferView>(value);
+}
+
+void ComputeShaderWritePlan::_write_element_counts() const {
+	// after every other entry, so the counts reflect the buffers as written by this execution
+	for (const auto& [entry_index, source] : element_counts) {
+		const Entry& entry = entries[entry_index];
+		entry.cursor.write_bytes(source.get_element_count(), entry.size, entry.matrix_layout);
+	}
+}
+
+bool ComputeShaderWritePlan::_has_nested_write_handlers(const Ref<ShaderTypeLayoutShape>& shape) {
+	if (const auto resource_shape = Object::cast_to<ResourceTypeLayoutShape>(shape.ptr())) {
+		// textures and samplers are resolved to RIDs on write, which may change without the parameter being set
+		return resource_shape->get_resource_type() != ResourceTypeLayoutShape::RAW_BYTES;
+	}
+	if (const auto array_shape = Object::cast_to<ArrayTypeLayoutShape>(shape.ptr())) {
+		return _has_nested_write_handlers(array_shape->get_element_shape());
+	}
+	if (const auto struct_shape = Object::cast_to<StructTypeLayoutShape>(shape.ptr())) {
+		for (const FieldShape& field : struct_shape->get_fields()) {
+			for (const StringName attribute_name : field.user_attributes.keys()) {
+				if (AttributeRegistry::get_instance()->get_write_handler(attribute_name)) {
+					return true;
+				}
+			}
+			if (_has_nested_write_handlers(field.shape)) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
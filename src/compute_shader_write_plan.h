@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+#include "compute_shader_cursor.h"
+#include "compute_shader_shape.h"
+
+class ComputeShaderWritePlan {
+
+public:
+	enum class EntryKind {
+		// struct whose fields are flattened into the entries that follow it
+		GROUP,
+		// plain data written directly to the target object
+		VALUE,
+		// anything else (arrays, resources, structs with write handlers), written through the cursor
+		GENERIC,
+	};
+
+	struct Entry {
+		godot::StringName key{};
+		EntryKind kind{};
+		// one past the last entry nested in this one
+		uint32_t end{};
+		uint32_t parent{};
+		int64_t size{};
+		ShaderTypeLayoutShape::MatrixLayout matrix_layout{};
+		// re-evaluated on every execution, e.g. fields with [gd::Time] or texture bindings
+		bool always_write{};
+		// this entry or one nested in it is always written
+		bool contains_always_write{};
+		ComputeShaderCursor cursor;
+	};
+
+	// a field marked [gd::ElementCount], written with the element count of a sibling buffer on every execution
+	struct ElementCountEntry {
+		uint32_t entry_index{};
+		ComputeShaderCursor source;
+	};
+
+	static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+	explicit ComputeShaderWritePlan(ComputeShaderObject* p_object);
+
+	[[nodiscard]] const std::vector<Entry>& get_entries() const { return entries; }
+
+	// index of the entry that has to be rewritten when the parameter at path changes, or -1
+	[[nodiscard]] int64_t find_entry(std::span<const godot::StringName> path) const;
+	void mark_dirty(const godot::StringName& path);
+	void mark_entry_dirty(uint32_t entry_index);
+	void mark_all_dirty();
+
+	void execute(const godot::Variant& data, const godot::Object* context = nullptr);
+
+private:
+	enum DirtyFlags : uint8_t {
+		CLEAN = 0,
+		DIRTY = 1 << 0,
+		NESTED_DIRTY = 1 << 1,
+	};
+
+	std::vector<Entry> entries{};
+	std::vector<uint8_t> dirty_flags{};
+	std::vector<ElementCountEntry> element_counts{};
+
+	void _compile(const ComputeShaderCursor& cursor, uint32_t parent);
+	void _execute(uint32_t begin, uint32_t end, const godot::Variant& data, const godot::Object* context);
+	void _mark_dirty(uint32_t entry_index);
+	void _write_element_counts() const;
+	static void _execute_entry(const Entry& entry, godot::Variant& value, const godot::Object* context);
+	static bool _is_uniform(const godot::Variant& value);
+	static bool _has_nested_write_handlers(const godot::Ref<ShaderTypeLayoutShape>& shape);
+};
@@ -0,0 +1,97 @@
+#include "constant_buffer_pool.h"
+
+#include <memory>
+
+using namespace godot;
+
+ConstantBufferPool::ConstantBufferPool(RenderingDevice* p_rendering_device) :
+		rendering_device(p_rendering_device), rendering_device_id(p_rendering_device ? p_rendering_device->get_instance_id() : ObjectID()) {
+	ERR_FAIL_NULL(rendering_device);
+}
+
+namespace {
+	struct Pools {
+		std::mutex mutex;
+		std::unordered_map<uint64_t, std::unique_ptr<ConstantBufferPool>> pools;
+	};
+
+	Pools& get_pools() {
+		static Pools pools;
+		return pools;
+	}
+}
+
+ConstantBufferPool::Allocation ConstantBufferPool::acquire(const PackedByteArray& data) {
+	ERR_FAIL_NULL_V(rendering_device, {});
+	const int64_t size_class = get_size_class(data.size());
+	{
+		std::lock_guard lock(mutex);
+		if (std::vector<RID>& rids = free_buffers[size_class]; !rids.empty()) {
+			const RID rid = rids.back();
+			rids.pop_back();
+			rendering_device->buffer_update(rid, 0, data.size(), data);
+			return { rid, size_class };
+		}
+	}
+	if (data.size() == size_class) {
+		return { rendering_device->uniform_buffer_create(size_class, data), size_class };
+	}
+	PackedByteArray initial_data = data;
+	initial_data.resize(size_class);
+	return { rendering_device->uniform_buffer_create(size_class, initial_data), size_class };
+}
+
+void ConstantBufferPool::release(const Allocation& allocation) {
+	if (!allocation.rid.is_valid())
+		return;
+	RenderingDevice* rd = Object::cast_to<RenderingDevice>(ObjectDB::get_instance(rendering_device_id));
+	if (!rd)
+		return;
+	std::lock_guard lock(mutex);
+	if (std::vector<RID>& rids = free_buffers[allocation.capacity]; rids.size() < MAX_FREE_BUFFERS_PER_CLASS) {
+		rids.push_back(allocation.rid);
+	} else {
+		rd->free_rid(allocation.rid);
+	}
+}
+
+ConstantBufferPool* ConstantBufferPool::get_for(RenderingDevice* rendering_device) {
+	ERR_FAIL_NULL_V(rendering_device, nullptr);
+	Pools& pools = get_pools();
+	std::lock_guard lock(pools.mutex);
+	const uint64_t id = rendering_device->get_instance_id();
+	if (const auto it = pools.pools.find(id); it != pools.pools.end()) {
+		return it->second.get();
+	}
+	// kept for the lifetime of the process, as buffers may release their allocations after the device is gone
+	return pools.pools.emplace(id, std::make_unique<ConstantBufferPool>(rendering_device)).first->second.get();
+}
+
+void ConstantBufferPool::free_unused_buffers() {
+	Pools& pools = get_pools();
+	std::lock_guard lock(pools.mutex);
+	for (const auto& [_, pool] : pools.pools) {
+		pool->_free_unused_buffers();
+	}
+}
+
+void ConstantBufferPool::_free_unused_buffers() {
+	std::lock_guard lock(mutex);
+	// the device may already be gone, taking its buffers with it
+	if (RenderingDevice* rd = Object::cast_to<RenderingDevice>(ObjectDB::get_instance(rendering_device_id))) {
+		for (const auto& [_, rids] : free_buffers) {
+			for (const RID& rid : rids) {
+				rd->free_rid(rid);
+			}
+		}
+	}
+	free_buffers.clear();
+}
+
+int64_t ConstantBufferPool::get_size_class(const int64_t size) {
+	int64_t size_class = MIN_SIZE_CLASS;
+	while (size_class < size) {
+		size_class <<= 1;
+	}
+	return size_class;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "godot_cpp/classes/rendering_device.hpp"
+#include "godot_cpp/variant/packed_byte_array.hpp"
+
+// uniform buffers shared by every ComputeBuffer of a rendering device, recycled through free lists per size class
+class ConstantBufferPool {
+
+public:
+	struct Allocation {
+		godot::RID rid{};
+		int64_t capacity{};
+	};
+
+	// the smallest size class, constant buffers are rounded up to a power of two starting here
+	static constexpr int64_t MIN_SIZE_CLASS = 256;
+	// released buffers beyond this many per size class are freed instead
+	static constexpr size_t MAX_FREE_BUFFERS_PER_CLASS = 64;
+
+	explicit ConstantBufferPool(godot::RenderingDevice* p_rendering_device);
+	ConstantBufferPool(const ConstantBufferPool&) = delete;
+	ConstantBufferPool& operator=(const ConstantBufferPool&) = delete;
+
+	// a buffer of at least data.size() bytes holding data, either recycled or newly created
+	Allocation acquire(const godot::PackedByteArray& data);
+	void release(const Allocation& allocation);
+
+	static ConstantBufferPool* get_for(godot::RenderingDevice* rendering_device);
+	// frees the released buffers of every pool, buffers still in use are returned to their pool as usual
+	static void free_unused_buffers();
+	static int64_t get_size_class(int64_t size);
+
+private:
+	godot::RenderingDevice* rendering_device;
+	godot::ObjectID rendering_device_id;
+	// keyed by size class
+	std::unordered_map<int64_t, std::vector<godot::RID>> free_buffers{};
+	std::mutex mutex{};
+
+	void _free_unused_buffers();
+};
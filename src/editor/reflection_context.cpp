@@ -1,3 +1,4 @@
+#include <array>
 #include <optional>
 
 #include "slang-com-ptr.h"
@@ -73,6 +74,9 @@ Ref<ShaderTypeLayoutShape> SlangReflectionContext::_get_shape(slang::TypeLayoutR
 			if (binding_type == slang::BindingType::ConstantBuffer || binding_type == slang::BindingType::ParameterBlock) {
 				binding_range.leaf_shape = leaf_shape;
 			}
+			if ((static_cast<int64_t>(binding_type) & SLANG_BINDING_TYPE_BASE_MASK) == SLANG_BINDING_TYPE_TYPED_BUFFER) {
+				binding_range.data_format = _to_godot_data_format(leaf_type->getResourceResultType());
+			}
 
 			const int64_t set_index = type_layout->getBindingRangeDescriptorSetIndex(i);
 			const int64_t range_index = type_layout->getBindingRangeFirstDescriptorRangeIndex(i);
@@ -184,9 +188,12 @@ Ref<ShaderTypeLayoutShape> SlangReflectionContext::_get_shape(slang::TypeLayoutR
 				Ref<VariantTypeLayoutShape> element_shape;
 				auto element_type = type_layout->getResourceResultType();
 				ERR_FAIL_NULL_V(element_type, nullptr);
-				const int64_t stride = _get_scalar_size(element_type->getScalarType()) * element_type->getColumnCount() * element_type->getRowCount();
+				const int64_t scalar_size = _get_scalar_size(element_type->getScalarType());
+				const int64_t component_count = element_type->getColumnCount() * element_type->getRowCount();
+				// 3-component elements are stored in 4-component texels, see _to_godot_data_format
+				const int64_t stride = scalar_size * (component_count == 3 ? 4 : component_count);
 				element_shape.instantiate();
-				element_shape->set_size(stride);
+				element_shape->set_size(scalar_size * component_count);
 				element_shape->set_matrix_layout(static_cast<ShaderTypeLayoutShape::MatrixLayout>(type_layout->getMatrixLayoutMode()));
 				Ref<ArrayTypeLayoutShape> shape;
 				shape.instantiate();
@@ -641,3 +648,49 @@ std::optional<RenderingDevice::UniformType> SlangReflectionContext::_to_godot_un
 			return {};
 	}
 }
+
+std::optional<RenderingDevice::DataFormat> SlangReflectionContext::_to_godot_data_format(slang::TypeReflection* element_type) {
+	if (!element_type)
+		return {};
+	int64_t component_count = 1;
+	if (element_type->getKind() == slang::TypeReflection::Kind::Vector) {
+		component_count = static_cast<int64_t>(element_type->getElementCount());
+		element_type = element_type->getElementType();
+		ERR_FAIL_NULL_V(element_type, {});
+	}
+	if (element_type->getKind() != slang::TypeReflection::Kind::Scalar || component_count < 1 || component_count > 4)
+		return {};
+	if (component_count == 3) {
+		// most devices can't use 3-component formats for texel buffers, the element stride is padded to match
+		UtilityFunctions::push_warning("Slang: 3-component texture buffer elements are stored as 4 components of ", element_type->getName());
+		component_count = 4;
+	}
+
+	// one format for 1, 2 and 4 components
+	using Formats = std::array<RenderingDevice::DataFormat, 3>;
+	const size_t format_index = component_count == 4 ? 2 : component_count - 1;
+	static constexpr Formats float32 = { RenderingDevice::DATA_FORMAT_R32_SFLOAT, RenderingDevice::DATA_FORMAT_R32G32_SFLOAT, RenderingDevice::DATA_FORMAT_R32G32B32A32_SFLOAT };
+	static constexpr Formats int32 = { RenderingDevice::DATA_FORMAT_R32_SINT, RenderingDevice::DATA_FORMAT_R32G32_SINT, RenderingDevice::DATA_FORMAT_R32G32B32A32_SINT };
+	static constexpr Formats uint32 = { RenderingDevice::DATA_FORMAT_R32_UINT, RenderingDevice::DATA_FORMAT_R32G32_UINT, RenderingDevice::DATA_FORMAT_R32G32B32A32_UINT };
+	static constexpr Formats float16 = { RenderingDevice::DATA_FORMAT_R16_SFLOAT, RenderingDevice::DATA_FORMAT_R16G16_SFLOAT, RenderingDevice::DATA_FORMAT_R16G16B16A16_SFLOAT };
+	static constexpr Formats int16 = { RenderingDevice::DATA_FORMAT_R16_SINT, RenderingDevice::DATA_FORMAT_R16G16_SINT, RenderingDevice::DATA_FORMAT_R16G16B16A16_SINT };
+	static constexpr Formats uint16 = { RenderingDevice::DATA_FORMAT_R16_UINT, RenderingDevice::DATA_FORMAT_R16G16_UINT, RenderingDevice::DATA_FORMAT_R16G16B16A16_UINT };
+
+	switch (element_type->getScalarType()) {
+		case slang::TypeReflection::ScalarType::Float32:
+			return float32[format_index];
+		case slang::TypeReflection::ScalarType::Int32:
+			return int32[format_index];
+		case slang::TypeReflection::ScalarType::UInt32:
+			return uint32[format_index];
+		case slang::TypeReflection::ScalarType::Float16:
+			return float16[format_index];
+		case slang::TypeReflection::ScalarType::Int16:
+			return int16[format_index];
+		case slang::TypeReflection::ScalarType::UInt16:
+			return uint16[format_index];
+		default:
+			UtilityFunctions::push_warning("Slang: Unsupported texture buffer element type: ", element_type->getName());
+			return {};
+	}
+}
@@ -65,4 +65,5 @@ private:
 
 	static int64_t _get_scalar_size(slang::TypeReflection::ScalarType scalar_type);
 	static std::optional<godot::RenderingDevice::UniformType> _to_godot_uniform_type(slang::BindingType type, SlangResourceShape resource_shape);
+	static std::optional<godot::RenderingDevice::DataFormat> _to_godot_data_format(slang::TypeReflection* element_type);
 };
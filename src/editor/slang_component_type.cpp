@@ -122,21 +122,23 @@ void SlangComponentType::_get_used_bindings_sets(slang::IMetadata* metadata, con
 	ERR_FAIL_NULL(metadata);
 	ComputeShaderObject global_object(nullptr, nullptr, global_params_shape);
 	ComputeShaderObject entry_point_object(nullptr, nullptr, entry_point_params_shape, kernel_space_offset, kernel_slot_offset);
-	ComputeShaderObject::DescriptorSets descriptor_sets;
+	ComputeShaderObject::DescriptorLayout descriptor_layout;
 	uint64_t next_space_index = 0;
-	const uint64_t active_space_index = global_object.get_descriptor_sets(descriptor_sets, next_space_index);
-	entry_point_object.get_descriptor_sets(descriptor_sets, active_space_index, next_space_index);
-	for (const auto& [space_index, uniforms] : descriptor_sets) {
+	const uint64_t active_space_index = global_object.get_descriptor_layout(descriptor_layout, next_space_index);
+	entry_point_object.get_descriptor_layout(descriptor_layout, active_space_index, next_space_index);
+	for (const auto& [space_index, objects] : descriptor_layout) {
 		bool set_used = out_used_binding_sets.get(space_index, false);
 		if (set_used)
 			continue;
-		for (const Ref<RDUniform> uniform : uniforms) {
-			if (uniform.is_valid()) {
-				if (_is_location_used(metadata, space_index, uniform->get_binding())) {
+		for (const ComputeShaderObject* object : objects) {
+			for (const auto& [binding_range_index, uniform] : object->get_uniforms()) {
+				if (_is_location_used(metadata, space_index, uniform.binding)) {
 					set_used = true;
 					break;
 				}
 			}
+			if (set_used)
+				break;
 		}
 		out_used_binding_sets.set(space_index, set_used);
 	}
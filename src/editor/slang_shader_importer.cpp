@@ -4,6 +4,7 @@
 #include <godot_cpp/classes/editor_interface.hpp>
 #include <godot_cpp/classes/file_access.hpp>
 #include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/classes/rendering_server.hpp>
 #include <godot_cpp/classes/resource_saver.hpp>
 
 #include "attributes.h"
@@ -56,6 +57,12 @@ TypedArray<Dictionary> SlangShaderImporter::_get_import_options(const String& p_
 		matrix_layout_option.set("hint_string", ShaderTypeLayoutShape::get_matrix_layout_hint_string());
 		options.push_back(matrix_layout_option);
 	}
+	{
+		Dictionary autowarm_option{};
+		autowarm_option.set("name", "autowarm");
+		autowarm_option.set("default_value", false);
+		options.push_back(autowarm_option);
+	}
 	return options;
 }
 
@@ -98,15 +105,20 @@ Error SlangShaderImporter::_import(const String& p_source_file, const String& p_
 	ERR_FAIL_NULL_V_MSG(module, ERR_COMPILATION_FAILED, String("[%s] Failed to load module!") % p_source_file);
 	const Ref<ComputeShaderFile> slang_shader = module->compile_shader(p_options.get("entry_points", {}));
 	ERR_FAIL_NULL_V_MSG(slang_shader, ERR_COMPILATION_FAILED, String("[%s] Failed to compile shader!") % module->get_file_path());
+	slang_shader->set_autowarm(p_options.get("autowarm", false));
 	const String base_error = slang_shader->get_base_error();
 	if (!base_error.is_empty()) {
 		UtilityFunctions::push_error(String("[%s] %s") % Array { p_source_file, base_error });
 	}
 
+	RenderingDevice* rendering_device = RenderingServer::get_singleton()->get_rendering_device();
 	for (const Ref<ComputeShaderKernel> kernel : slang_shader->get_kernels()) {
 		const String compile_error = kernel->get_compile_error().trim_suffix("\n");
 		if (!compile_error.is_empty()) {
 			UtilityFunctions::push_error(String("[%s] Slang compile error:\n%s") % Array({ module->get_file_path(), compile_error }));
+		} else if (rendering_device) {
+			// driver-ready bytecode skips SPIR-V compilation at runtime on devices matching the editor's
+			kernel->compile_bytecode(rendering_device);
 		}
 	}
 
@@ -5,6 +5,7 @@
 #include <godot_cpp/core/defs.hpp>
 #include <godot_cpp/godot.hpp>
 
+#include "compute_buffer_view.h"
 #include "compute_dispatch_context.h"
 #include "compute_shader_effect.h"
 #include "compute_shader_file.h"
@@ -12,6 +13,7 @@
 #include "compute_shader_shape.h"
 #include "compute_shader_task.h"
 #include "compute_texture.h"
+#include "constant_buffer_pool.h"
 
 #ifdef SLANG_IMPORT_ENABLED
 #include "slang_shader_editor_plugin.h"
@@ -39,6 +41,7 @@ void initialize_gdextension_types(const ModuleInitializationLevel p_level) {
 		GDREGISTER_VIRTUAL_CLASS(ComputeTextureDispatchContext);
 		GDREGISTER_CLASS(ComputeShaderEffect);
 		GDREGISTER_CLASS(ComputeTexture);
+		GDREGISTER_CLASS(ComputeBufferView);
 #ifdef SLANG_IMPORT_ENABLED
 		GDREGISTER_ABSTRACT_CLASS(SlangComponentType);
 		GDREGISTER_CLASS(gdslang::SlangSession);
@@ -57,6 +60,9 @@ void initialize_gdextension_types(const ModuleInitializationLevel p_level) {
 }
 
 void uninitialize_gdextension_types(const ModuleInitializationLevel p_level) {
+	if (p_level == MODULE_INITIALIZATION_LEVEL_SCENE) {
+		ConstantBufferPool::free_unused_buffers();
+	}
 #if defined(SLANG_IMPORT_ENABLED) && defined(TOOLS_ENABLED)
 	if (p_level == MODULE_INITIALIZATION_LEVEL_EDITOR) {
 		EditorPlugins::remove_by_type<SlangShaderEditorPlugin>();
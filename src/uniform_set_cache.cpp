@@ -0,0 +1,77 @@
+#include "uniform_set_cache.h"
+
+using namespace godot;
+
+Ref<RDUniform> UniformSlot::to_uniform() const {
+	Ref<RDUniform> uniform{};
+	uniform.instantiate();
+	uniform->set_binding(binding);
+	uniform->set_uniform_type(uniform_type);
+	for (const RID& id : ids) {
+		uniform->add_id(id);
+	}
+	return uniform;
+}
+
+UniformSetCache::UniformSetCache(RenderingDevice* p_rendering_device, const size_t p_capacity) :
+		rd(p_rendering_device), rd_id(p_rendering_device ? p_rendering_device->get_instance_id() : ObjectID{}), capacity(p_capacity) {
+	ERR_FAIL_NULL(rd);
+}
+
+UniformSetCache::~UniformSetCache() {
+	cache.clear();
+	while (!entries.empty()) {
+		_erase(entries.begin());
+	}
+}
+
+RID UniformSetCache::get_uniform_set(const RID& shader, const uint64_t set_index, const std::span<const UniformSlot* const> uniforms) {
+	ERR_FAIL_NULL_V(rd, {});
+	UniformSetKey cache_key{ shader, set_index, {} };
+	for (const UniformSlot* uniform : uniforms) {
+		ERR_CONTINUE(!uniform);
+		cache_key.uniforms.push_back(uniform->binding);
+		cache_key.uniforms.push_back(uniform->uniform_type);
+		cache_key.uniforms.push_back(uniform->ids.size());
+		for (const RID& id : uniform->ids) {
+			cache_key.uniforms.push_back(id.get_id());
+		}
+	}
+
+	if (const auto it = cache.find(cache_key); it != cache.end()) {
+		const auto entry = it->second;
+		// the rendering device frees uniform sets whose resources were freed
+		if (rd->uniform_set_is_valid(entry->uniform_set)) {
+			entries.splice(entries.begin(), entries, entry);
+			return entry->uniform_set;
+		}
+		cache.erase(it);
+		_erase(entry);
+	}
+
+	// RDUniform objects are only needed to create the set
+	TypedArray<Ref<RDUniform>> rd_uniforms{};
+	for (const UniformSlot* uniform : uniforms) {
+		if (uniform) {
+			rd_uniforms.push_back(uniform->to_uniform());
+		}
+	}
+	const RID uniform_set = rd->uniform_set_create(rd_uniforms, shader, set_index);
+	ERR_FAIL_COND_V(!uniform_set.is_valid(), {});
+	while (!entries.empty() && entries.size() >= capacity) {
+		cache.erase(entries.back().key);
+		_erase(std::prev(entries.end()));
+	}
+	entries.push_front(CacheEntry{ std::move(cache_key), UniqueRID(rd, uniform_set) });
+	cache.emplace(entries.front().key, entries.begin());
+	return uniform_set;
+}
+
+void UniformSetCache::_erase(const std::list<CacheEntry>::iterator entry) {
+	const auto rendering_device = Object::cast_to<RenderingDevice>(ObjectDB::get_instance(rd_id));
+	if (!rendering_device || !rendering_device->uniform_set_is_valid(entry->uniform_set)) {
+		// already freed along with one of its resources (or the device itself)
+		entry->uniform_set.release();
+	}
+	entries.erase(entry);
+}
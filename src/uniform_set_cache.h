@@ -0,0 +1,77 @@
+#pragma once
+
+#include <list>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "godot_cpp/classes/rd_uniform.hpp"
+#include "godot_cpp/classes/rendering_device.hpp"
+#include "godot_cpp/variant/typed_array.hpp"
+
+#include "rids.h"
+
+// native form of an RDUniform, only turned into one when a uniform set is created
+struct UniformSlot {
+	int64_t binding{};
+	godot::RenderingDevice::UniformType uniform_type{};
+	std::vector<godot::RID> ids{};
+
+	bool operator==(const UniformSlot& other) const = default;
+
+	[[nodiscard]] godot::Ref<godot::RDUniform> to_uniform() const;
+};
+
+class UniformSetCache {
+
+private:
+	struct UniformSetKey {
+		godot::RID shader;
+		uint64_t set_index;
+		// binding, uniform type, id count and ids of each uniform, in order
+		std::vector<uint64_t> uniforms;
+
+		bool operator==(const UniformSetKey& other) const {
+			return shader == other.shader && set_index == other.set_index && uniforms == other.uniforms;
+		}
+	};
+
+	struct UniformSetKeyHasher {
+		size_t operator()(const UniformSetKey& key) const {
+			size_t seed = std::hash<uint64_t>()(key.shader.get_id());
+			hash_combine(seed, key.set_index);
+			for (const uint64_t value : key.uniforms) {
+				hash_combine(seed, value);
+			}
+			return seed;
+		}
+
+		static void hash_combine(size_t& seed, const uint64_t value) {
+			seed ^= std::hash<uint64_t>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+		}
+	};
+
+	struct CacheEntry {
+		UniformSetKey key;
+		UniqueRID<godot::RenderingDevice> uniform_set;
+	};
+
+	godot::RenderingDevice* rd;
+	godot::ObjectID rd_id;
+	size_t capacity;
+	// most recently used first
+	std::list<CacheEntry> entries;
+	std::unordered_map<UniformSetKey, std::list<CacheEntry>::iterator, UniformSetKeyHasher> cache;
+
+	void _erase(std::list<CacheEntry>::iterator entry);
+
+public:
+	static constexpr size_t DEFAULT_CAPACITY = 256;
+
+	explicit UniformSetCache(godot::RenderingDevice* p_rendering_device, size_t p_capacity = DEFAULT_CAPACITY);
+	UniformSetCache(const UniformSetCache&) = delete;
+	UniformSetCache& operator=(const UniformSetCache&) = delete;
+	~UniformSetCache();
+
+	godot::RID get_uniform_set(const godot::RID& shader, uint64_t set_index, std::span<const UniformSlot* const> uniforms);
+};
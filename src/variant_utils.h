@@ -1,6 +1,10 @@
 #pragma once
 
+#include <vector>
+
 #include "godot_cpp/templates/hashfuncs.hpp"
+#include "godot_cpp/variant/packed_string_array.hpp"
+#include "godot_cpp/variant/string_name.hpp"
 
 namespace gdslang {
     struct GodotHasher {
@@ -9,4 +13,15 @@ namespace gdslang {
             return static_cast<size_t>(godot::HashMapHasherDefault::hash(k));
         }
     };
+
+    // splits a parameter path like "a/b/c" into its parts, interned once so they can be looked up repeatedly
+    inline std::vector<godot::StringName> split_path(const godot::String& path) {
+        const godot::PackedStringArray parts = path.split("/");
+        std::vector<godot::StringName> result{};
+        result.reserve(parts.size());
+        for (const godot::String& part : parts) {
+            result.emplace_back(part);
+        }
+        return result;
+    }
 }